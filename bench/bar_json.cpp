@@ -0,0 +1,97 @@
+// Compares the streaming bar serializer against the nlohmann DOM path it replaced.
+//
+//   bench-bar-json [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "src/SemmetyBarState.hpp"
+
+static SemmetyBarState makeState(size_t numWindows) {
+	SemmetyBarState state;
+
+	for (size_t i = 0; i < numWindows; i++) {
+		state.windows.push_back(SemmetyBarWindow {
+		    .address = std::to_string(0x55d0c0de0000 + i * 0x1a0),
+		    .title = "~/src/semmety: nvim src/SemmetyLayout.cpp \"" + std::to_string(i) + "\" — zsh",
+		    .appid = i % 3 == 0 ? "firefox" : "kitty",
+		    .urgent = i % 17 == 0,
+		    .focused = i == 0,
+		    .minimized = i % 2 == 1,
+		});
+	}
+
+	for (int id = 1; id <= 8; id++) {
+		state.workspaces.push_back({
+		    .id = id,
+		    .name = std::to_string(id),
+		    .numWindows = numWindows / 8,
+		    .focused = id == 1,
+		    .urgent = id == 3,
+		});
+	}
+
+	return state;
+}
+
+template <typename Fn>
+static double nsPerIteration(size_t iterations, Fn&& fn) {
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++) { fn(); }
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main(int argc, char** argv) {
+	const size_t baseIterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+
+	std::printf(
+	    "%8s %10s %14s %14s %8s\n",
+	    "windows",
+	    "bytes",
+	    "dom ns/op",
+	    "stream ns/op",
+	    "speedup"
+	);
+
+	for (const size_t numWindows: {10, 100, 1000}) {
+		const auto state = makeState(numWindows);
+		const auto iterations = std::max<size_t>(baseIterations / numWindows, 10);
+
+		// the streaming writer must stay byte-for-byte compatible with the old output
+		const auto expected = barStateToJson(state).dump();
+		std::string buffer;
+		writeBarStateJson(buffer, state);
+		if (buffer != expected) {
+			std::fprintf(stderr, "output mismatch at %zu windows\n", numWindows);
+			return 1;
+		}
+
+		size_t sink = 0;
+		const auto domNs = nsPerIteration(iterations, [&]() {
+			sink += barStateToJson(state).dump().size();
+		});
+
+		const auto streamNs = nsPerIteration(iterations, [&]() {
+			buffer.clear();
+			writeBarStateJson(buffer, state);
+			sink += buffer.size();
+		});
+
+		std::printf(
+		    "%8zu %10zu %14.0f %14.0f %7.1fx\n",
+		    numWindows,
+		    expected.size(),
+		    domNs,
+		    streamNs,
+		    domNs / streamNs
+		);
+
+		if (sink == 0) { return 1; }
+	}
+
+	return 0;
+}
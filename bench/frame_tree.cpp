@@ -0,0 +1,256 @@
+// Times the frame tree operations the dispatchers and layout callbacks lean on, on the headless
+// stand-in workspace. Trees are balanced (every split halves the leaves) or degenerate (every split
+// keeps one leaf and nests the rest, like always splitting the newest frame). Every tree also has a
+// quarter as many hidden windows as leaves, so getNextWindow and removeWindow have something to
+// find. Prints one JSON document to stdout.
+//
+// An operation that took longer than the skip threshold per call is not run on the larger trees of
+// the same shape, several are quadratic or worse in the window count and would take hours at 10k
+// leaves. Those are reported with "skipped": true.
+//
+//   bench-frame-tree [ms per case] [max leaves] [skip threshold ms]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "src/SemmetyFrameUtils.hpp"
+#include "src/SemmetyStandIn.hpp"
+#include "src/json.hpp"
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+enum class eTreeShape {
+	Balanced,
+	Degenerate,
+};
+
+static const char* shapeName(eTreeShape shape) {
+	switch (shape) {
+	case eTreeShape::Balanced: return "balanced";
+	case eTreeShape::Degenerate: return "degenerate";
+	}
+
+	return "";
+}
+
+class CBenchWorkspace: public SemmetyStandInWorkspace {
+public:
+	CBenchWorkspace(): SemmetyStandInWorkspace(CBox(0, 0, 3840, 2160)) {}
+
+	// What replaceNode() does for the root, minus refilling the frames and checking every window's
+	// visibility, which are quadratic in the windows.
+	void setRoot(const SP<SemmetyFrame>& frame) {
+		frame->geometry = root->geometry;
+		root = frame;
+		updateFramePathsRecursive(root, {});
+		root->applyRecursive(*this, std::nullopt, true);
+	}
+};
+
+struct SBenchTree {
+	CBenchWorkspace workspace;
+	std::vector<SP<SemmetyLeafFrame>> leaves;
+	std::vector<SemmetyWindowRef> framedWindows;
+	uint64_t nextWindowId = 1;
+
+	SP<SemmetyLeafFrame> createLeaf() {
+		auto window = SemmetyStandInWindow::create(nextWindowId++);
+		workspace.windows.push_back(window);
+		framedWindows.push_back(window);
+
+		return SemmetyLeafFrame::create(window);
+	}
+
+	// Halves `box` the way SemmetySplitFrame picks its split direction.
+	static std::pair<CBox, CBox> splitBox(const CBox& box) {
+		if (box.width > box.height) {
+			return {
+			    CBox(box.x, box.y, box.width / 2, box.height),
+			    CBox(box.x + box.width / 2, box.y, box.width / 2, box.height),
+			};
+		}
+
+		return {
+		    CBox(box.x, box.y, box.width, box.height / 2),
+		    CBox(box.x, box.y + box.height / 2, box.width, box.height / 2),
+		};
+	}
+
+	SP<SemmetyFrame> build(eTreeShape shape, const CBox& box, size_t numLeaves) {
+		if (numLeaves == 1) { return createLeaf(); }
+
+		const auto [firstBox, secondBox] = splitBox(box);
+		const auto firstLeaves = shape == eTreeShape::Balanced ? numLeaves / 2 : 1;
+
+		auto first = build(shape, firstBox, firstLeaves);
+		auto second = build(shape, secondBox, numLeaves - firstLeaves);
+
+		return SemmetySplitFrame::create(first, second, box);
+	}
+
+	SBenchTree(eTreeShape shape, size_t numLeaves) {
+		auto root = build(shape, workspace.getRoot()->geometry, numLeaves);
+
+		for (size_t i = 0; i < std::max<size_t>(numLeaves / 4, 1); i++) {
+			auto window = SemmetyStandInWindow::create(nextWindowId++);
+			window->hidden = true;
+			workspace.windows.push_back(window);
+		}
+
+		workspace.setRoot(root);
+		leaves = root->getLeafFrames();
+		workspace.setFocusedFrame(leaves.front());
+	}
+};
+
+struct SBenchResult {
+	size_t iterations = 0;
+	double nsPerOp = 0;
+};
+
+// Runs `op` for at least `budget`, always at least once. `op` returns the time it wants counted so
+// it can leave the tree as it found it without timing the cleanup.
+static SBenchResult run(Clock::duration budget, const std::function<Clock::duration(size_t)>& op) {
+	SBenchResult result;
+	Clock::duration measured {};
+
+	const auto start = Clock::now();
+	do {
+		measured += op(result.iterations);
+		result.iterations += 1;
+	} while (Clock::now() - start < budget);
+
+	result.nsPerOp =
+	    std::chrono::duration<double, std::nano>(measured).count() / result.iterations;
+	return result;
+}
+
+template <typename Fn>
+static Clock::duration timed(Fn&& fn) {
+	const auto start = Clock::now();
+	fn();
+	return Clock::now() - start;
+}
+
+static const Direction directions[] = {
+    Direction::Up,
+    Direction::Right,
+    Direction::Down,
+    Direction::Left,
+};
+
+int main(int argc, char** argv) {
+	const auto budget =
+	    std::chrono::milliseconds(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200);
+	const size_t maxLeaves = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+	const double skipAboveNs = (argc > 3 ? std::strtod(argv[3], nullptr) : 50) * 1e6;
+
+	json results = json::array();
+
+	for (const auto shape: {eTreeShape::Balanced, eTreeShape::Degenerate}) {
+		std::unordered_set<std::string> slowOps;
+
+		for (const size_t numLeaves: {4, 64, 1000, 10000}) {
+			if (numLeaves > maxLeaves) { continue; }
+
+			SBenchTree tree(shape, numLeaves);
+			auto& workspace = tree.workspace;
+			const auto& leaves = tree.leaves;
+
+			const auto measure = [&](const char* op, const std::function<Clock::duration(size_t)>& fn) {
+				if (slowOps.contains(op)) {
+					results.push_back({
+					    {"op", op},
+					    {"shape", shapeName(shape)},
+					    {"leaves", numLeaves},
+					    {"skipped", true},
+					});
+					return;
+				}
+
+				const auto result = run(budget, fn);
+				if (result.nsPerOp > skipAboveNs) { slowOps.insert(op); }
+
+				std::fprintf(
+				    stderr,
+				    "%-12s %6zu %-24s %12.0f ns/op\n",
+				    shapeName(shape),
+				    numLeaves,
+				    op,
+				    result.nsPerOp
+				);
+
+				results.push_back({
+				    {"op", op},
+				    {"shape", shapeName(shape)},
+				    {"leaves", numLeaves},
+				    {"iterations", result.iterations},
+				    {"nsPerOp", result.nsPerOp},
+				});
+			};
+
+			// splits a leaf and removes the split again, so both calls count
+			measure("replaceNode", [&](size_t i) {
+				const auto leaf = leaves[i % leaves.size()];
+				const auto split =
+				    SemmetySplitFrame::create(leaf, SemmetyLeafFrame::create(), leaf->geometry);
+
+				const auto elapsed = timed([&]() {
+					replaceNode(leaf, split, workspace);
+					replaceNode(split, leaf, workspace);
+				});
+				return elapsed / 2;
+			});
+
+			measure("getLeafFrames", [&](size_t) {
+				return timed([&]() { workspace.getRoot()->getLeafFrames(); });
+			});
+
+			measure("getFrameForWindow", [&](size_t i) {
+				const auto& window = tree.framedWindows[i % tree.framedWindows.size()];
+				return timed([&]() { workspace.getFrameForWindow(window); });
+			});
+
+			measure("getNeighborByDirection", [&](size_t i) {
+				const auto& leaf = leaves[i % leaves.size()];
+				return timed([&]() { getNeighborByDirection(workspace, leaf, directions[i % 4]); });
+			});
+
+			measure("getResizeTarget", [&](size_t i) {
+				const auto& leaf = leaves[i % leaves.size()];
+				return timed([&]() { getResizeTarget(workspace, leaf, directions[i % 4]); });
+			});
+
+			measure("applyRecursive", [&](size_t) {
+				return timed([&]() {
+					workspace.getRoot()->applyRecursive(workspace, std::nullopt, false);
+				});
+			});
+
+			measure("getNextWindow", [&](size_t) {
+				return timed([&]() { workspace.getNextWindow(nextTiledWindowParams); });
+			});
+
+			// the frame takes one of the hidden windows, the removed one comes back as a hidden window
+			measure("removeWindow", [&](size_t i) {
+				const auto window = leaves[i % leaves.size()]->getWindow();
+				if (!window) { return Clock::duration {}; }
+
+				const auto elapsed = timed([&]() { workspace.removeWindow(window); });
+
+				window->setHidden(true);
+				workspace.windows.push_back(window);
+				return elapsed;
+			});
+		}
+	}
+
+	std::printf("%s\n", json({{"benchmark", "frame-tree"}, {"results", results}}).dump(2).c_str());
+}
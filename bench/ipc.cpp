@@ -0,0 +1,359 @@
+// Runs the bar event manager against a stand-in compositor event loop with simulated clients: fast
+// ones that read everything, slow ones that read a little at a time and stalled ones that never
+// read. Reports the compositor-thread cost of a publish, bytes written, queue depths and delivery
+// latency.
+//
+//   bench-ipc [seconds] [rate] [fast] [slow] [stalled] [windows]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hyprland/src/Compositor.hpp>
+
+#include "src/SemmetyEventManager.hpp"
+
+enum class eClientKind {
+	Fast,
+	Slow,
+	Stalled,
+};
+
+static const char* kindName(eClientKind kind) {
+	switch (kind) {
+	case eClientKind::Fast: return "fast";
+	case eClientKind::Slow: return "slow";
+	case eClientKind::Stalled: return "stalled";
+	}
+
+	return "";
+}
+
+static uint64_t monotonicMicros() {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+static int connectTo(const std::string& path) {
+	const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+	sockaddr_un address = {.sun_family = AF_UNIX};
+	path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+	if (connect(fd, (sockaddr*) &address, SUN_LEN(&address)) < 0) {
+		std::perror("connect");
+		std::exit(1);
+	}
+
+	return fd;
+}
+
+struct SClient {
+	eClientKind kind;
+	int fd = -1;
+	std::thread thread;
+	// written by the client's thread, read once it has been joined
+	std::vector<uint64_t> latencies;
+	uint64_t bytesRead = 0;
+	// filled from the stats replies
+	size_t maxQueued = 0;
+	double queuedSum = 0;
+	uint64_t bytesWritten = 0;
+	uint64_t conflated = 0;
+};
+
+// Reads newline delimited updates and records how long after publishing each one arrived. Slow
+// clients read 4 KiB every 10 ms, far less than a busy bar produces.
+static void readUpdates(SClient& client) {
+	std::string buffer;
+	char chunk[4096];
+
+	while (true) {
+		const auto length = read(client.fd, chunk, sizeof(chunk));
+		if (length <= 0) { return; }
+
+		const auto now = monotonicMicros();
+		client.bytesRead += length;
+		buffer.append(chunk, length);
+
+		size_t start = 0;
+		for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1) {
+			const auto time = buffer.find("\"time\":", start);
+			if (time < end) {
+				client.latencies.push_back(now - std::strtoull(&buffer[time + 7], nullptr, 10));
+			}
+		}
+		buffer.erase(0, start);
+
+		if (client.kind == eClientKind::Slow) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+}
+
+// The observer only subscribes to a topic that never changes, and polls "stats" for the queue
+// depth of the others. Its replies list the clients in the order they connected.
+class CObserver {
+public:
+	explicit CObserver(const std::string& path): m_fd(connectTo(path)) {
+		send("subscribe focus\n");
+	}
+
+	~CObserver() { close(m_fd); }
+
+	json stats() {
+		send("stats\n");
+
+		while (true) {
+			size_t end;
+			while ((end = m_buffer.find('\n')) == std::string::npos) {
+				char chunk[4096];
+				const auto length = read(m_fd, chunk, sizeof(chunk));
+				if (length <= 0) {
+					std::fprintf(stderr, "observer lost its connection\n");
+					std::exit(1);
+				}
+
+				m_buffer.append(chunk, length);
+			}
+
+			auto message = json::parse(m_buffer.substr(0, end));
+			m_buffer.erase(0, end + 1);
+			if (message["type"] == "stats") { return message; }
+		}
+	}
+
+private:
+	int m_fd;
+	std::string m_buffer;
+
+	void send(std::string_view command) {
+		if (write(m_fd, command.data(), command.size()) < 0) { std::perror("write"); }
+	}
+};
+
+static SemmetyBarState makeState(size_t numWindows, uint64_t tick) {
+	SemmetyBarState state;
+
+	for (size_t i = 0; i < numWindows; i++) {
+		std::string title = "~/src/semmety: nvim src/SemmetyLayout.cpp";
+		// the focused window's title changes with every update, like a terminal running a build
+		if (i == tick % numWindows) { title += " " + std::to_string(tick); }
+
+		state.windows.push_back(SemmetyBarWindow {
+		    .address = std::to_string(0x55d0c0de0000 + i * 0x1a0),
+		    .title = std::move(title),
+		    .appid = i % 3 == 0 ? "firefox" : "kitty",
+		    .focused = i == tick % numWindows,
+		    .minimized = i % 2 == 1,
+		});
+	}
+
+	for (int id = 1; id <= 8; id++) {
+		state.workspaces.push_back({
+		    .id = id,
+		    .name = std::to_string(id),
+		    .numWindows = numWindows / 8,
+		    .focused = id == 1,
+		});
+	}
+
+	return state;
+}
+
+template <typename T>
+static T percentile(std::vector<T>& values, double p) {
+	if (values.empty()) { return 0; }
+
+	const auto index = std::min(values.size() - 1, (size_t) (p * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+int main(int argc, char** argv) {
+	const auto arg = [&](int index, unsigned long fallback) {
+		return argc > index ? std::strtoul(argv[index], nullptr, 10) : fallback;
+	};
+
+	const auto seconds = arg(1, 2);
+	const auto rate = std::max(arg(2, 240), 1ul);
+	const auto numFast = arg(3, 4);
+	const auto numSlow = arg(4, 2);
+	const auto numStalled = arg(5, 2);
+	const auto numWindows = arg(6, 50);
+
+	std::string instance = std::filesystem::temp_directory_path() / "semmety-bench-XXXXXX";
+	if (mkdtemp(instance.data()) == nullptr) {
+		std::perror("mkdtemp");
+		return 1;
+	}
+
+	g_pCompositor = makeUnique<CCompositor>();
+	g_pCompositor->m_instancePath = instance;
+	g_pCompositor->m_wlEventLoop = wl_event_loop_create();
+
+	uint64_t tick = 0;
+	std::vector<double> publishMicros;
+	const auto publish = [&]() {
+		auto state = makeState(numWindows, tick++);
+
+		const auto start = std::chrono::steady_clock::now();
+		g_SemmetyEventManager->postBarUpdate(std::move(state));
+		const auto elapsed = std::chrono::steady_clock::now() - start;
+
+		publishMicros.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+	};
+
+	g_SemmetyEventManager = makeUnique<SemmetyEventManager>(publish);
+
+	const auto path = instance + "/.semmety-socket2.sock";
+	CObserver observer(path);
+
+	std::vector<SClient> clients;
+	clients.reserve(numFast + numSlow + numStalled);
+	for (size_t i = 0; i < numFast; i++) { clients.push_back({.kind = eClientKind::Fast}); }
+	for (size_t i = 0; i < numSlow; i++) { clients.push_back({.kind = eClientKind::Slow}); }
+	for (size_t i = 0; i < numStalled; i++) { clients.push_back({.kind = eClientKind::Stalled}); }
+
+	for (auto& client: clients) {
+		client.fd = connectTo(path);
+		if (client.kind != eClientKind::Stalled) {
+			client.thread = std::thread([&client] { readUpdates(client); });
+		}
+	}
+
+	// wait for the I/O thread to accept everyone, the observer included
+	while (observer.stats()["clients"].size() < clients.size() + 1) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	// Publish at the requested rate, serving the compositor loop in between like Hyprland would.
+	// Stats are sampled every 50 ms.
+	const auto interval = std::chrono::nanoseconds(1000000000 / rate);
+	const auto start = std::chrono::steady_clock::now();
+	const auto end = start + std::chrono::seconds(seconds);
+	auto nextPublish = start;
+	auto nextSample = start;
+	size_t samples = 0;
+
+	for (auto now = start; now < end; now = std::chrono::steady_clock::now()) {
+		if (now >= nextPublish) {
+			publish();
+			nextPublish += interval;
+		}
+
+		if (now >= nextSample) {
+			const auto stats = observer.stats()["clients"];
+			for (size_t i = 0; i < clients.size() && i + 1 < stats.size(); i++) {
+				const size_t queued = stats[i + 1]["queued"];
+				clients[i].maxQueued = std::max(clients[i].maxQueued, queued);
+				clients[i].queuedSum += queued;
+			}
+
+			samples += 1;
+			nextSample += std::chrono::milliseconds(50);
+		}
+
+		const auto wait = std::min(nextPublish, nextSample) - std::chrono::steady_clock::now();
+		const auto waitMs = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+		wl_event_loop_dispatch(g_pCompositor->m_wlEventLoop, std::max<int>(waitMs, 0));
+	}
+
+	// give the readers a moment to drain what is still queued
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	const auto stats = observer.stats();
+	for (size_t i = 0; i < clients.size() && i + 1 < stats["clients"].size(); i++) {
+		clients[i].bytesWritten = stats["clients"][i + 1]["bytesWritten"];
+		clients[i].conflated = stats["clients"][i + 1]["conflated"];
+	}
+
+	g_SemmetyEventManager.reset();
+	for (auto& client: clients) {
+		shutdown(client.fd, SHUT_RDWR);
+		if (client.thread.joinable()) { client.thread.join(); }
+		close(client.fd);
+	}
+
+	const auto published = publishMicros.size();
+	std::printf(
+	    "%zu publishes of %zu windows in %lus, %lu dropped on hand-off\n",
+	    published,
+	    (size_t) numWindows,
+	    seconds,
+	    stats["droppedUpdates"].get<uint64_t>()
+	);
+	std::printf(
+	    "compositor thread per publish: p50 %.2f us, p99 %.2f us, max %.2f us\n\n",
+	    percentile(publishMicros, 0.5),
+	    percentile(publishMicros, 0.99),
+	    percentile(publishMicros, 1)
+	);
+
+	std::printf(
+	    "%8s %8s %12s %12s %10s %10s %10s %10s %10s %10s\n",
+	    "kind",
+	    "clients",
+	    "written",
+	    "read",
+	    "conflated",
+	    "avg queue",
+	    "max queue",
+	    "p50 us",
+	    "p99 us",
+	    "max us"
+	);
+
+	for (const auto kind: {eClientKind::Fast, eClientKind::Slow, eClientKind::Stalled}) {
+		size_t count = 0;
+		uint64_t written = 0;
+		uint64_t read = 0;
+		uint64_t conflated = 0;
+		double queuedSum = 0;
+		size_t maxQueued = 0;
+		std::vector<uint64_t> latencies;
+
+		for (const auto& client: clients) {
+			if (client.kind != kind) { continue; }
+
+			count += 1;
+			written += client.bytesWritten;
+			read += client.bytesRead;
+			conflated += client.conflated;
+			queuedSum += client.queuedSum;
+			maxQueued = std::max(maxQueued, client.maxQueued);
+			latencies.insert(latencies.end(), client.latencies.begin(), client.latencies.end());
+		}
+
+		if (count == 0) { continue; }
+
+		std::printf(
+		    "%8s %8zu %12lu %12lu %10lu %10.1f %10zu %10lu %10lu %10lu\n",
+		    kindName(kind),
+		    count,
+		    written,
+		    read,
+		    conflated,
+		    samples > 0 ? queuedSum / (samples * count) : 0.0,
+		    maxQueued,
+		    percentile(latencies, 0.5),
+		    percentile(latencies, 0.99),
+		    percentile(latencies, 1)
+		);
+	}
+
+	wl_event_loop_destroy(g_pCompositor->m_wlEventLoop);
+	std::filesystem::remove_all(instance);
+	return 0;
+}
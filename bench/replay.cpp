@@ -0,0 +1,253 @@
+// Replays a trace recorded with plugin:semmety:trace_file against the stand-in compositor and
+// reports how long each entry point took, plus the final tree hash of every workspace next to the
+// hash the plugin recorded when the trace was closed.
+//
+// Dispatchers that need the compositor (jump, debug, updatebar, dumpspans, dumpflight, loglevel)
+// are counted but not replayed, and the workspace of the last dispatch or focus change stands in
+// for the focused monitor's one.
+// With --check the workspace invariants are tested after every event.
+//
+//   semmety-replay <trace> [--check]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "src/SemmetyLayoutDispatchers.hpp"
+#include "src/SemmetyStandIn.hpp"
+#include "src/SemmetyTrace.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+class CReplay {
+public:
+	std::map<int64_t, std::unique_ptr<SemmetyStandInWorkspace>> workspaces;
+	std::map<int64_t, uint64_t> recordedHashes;
+	std::unordered_map<uint64_t, SP<SemmetyStandInWindow>> windows;
+	std::map<std::string, size_t> skipped;
+
+	SemmetyStandInWorkspace& getWorkspace(int64_t id) {
+		auto& workspace = workspaces[id];
+		if (!workspace) {
+			workspace = std::make_unique<SemmetyStandInWorkspace>(CBox(0, 0, 1920, 1080), false);
+		}
+
+		return *workspace;
+	}
+
+	SP<SemmetyStandInWindow> getWindow(uint64_t id) {
+		auto& window = windows[id];
+		if (!window) { window = SemmetyStandInWindow::create(id); }
+
+		return window;
+	}
+
+	void setActiveWorkspace(int64_t id) {
+		for (auto& [workspaceId, workspace]: workspaces) { workspace->active = workspaceId == id; }
+	}
+
+	// The entry point name the plugin logs for the record.
+	static std::string label(const SemmetyTraceRecord& record) {
+		switch (record.event) {
+		case SemmetyTraceEvent::Workspace: return "createWorkspace";
+		case SemmetyTraceEvent::Dispatch: return "semmety:" + record.name;
+		case SemmetyTraceEvent::NewTarget: return "newTarget";
+		case SemmetyTraceEvent::RemoveTarget: return "removeTarget";
+		case SemmetyTraceEvent::Focus: return "onWindowFocusChange";
+		case SemmetyTraceEvent::Recalculate: return "recalculate";
+		case SemmetyTraceEvent::ResizeTarget: return "resizeTarget";
+		case SemmetyTraceEvent::Hash: return "hash";
+		}
+
+		return "unknown";
+	}
+
+	// Does what the plugin's entry point did with the record.
+	void apply(const SemmetyTraceRecord& record) {
+		switch (record.event) {
+		case SemmetyTraceEvent::Workspace:
+			getWorkspace(record.workspace).setRootGeometry(record.box);
+			break;
+		case SemmetyTraceEvent::Dispatch: {
+			auto& workspace = getWorkspace(record.workspace);
+			setActiveWorkspace(record.workspace);
+
+			const auto& dispatchers = getLayoutDispatchers();
+			if (auto it = dispatchers.find(record.name); it != dispatchers.end()) {
+				it->second(workspace, workspace.getFocusedFrame(), CVarList(record.args));
+			} else if (record.name == "movetoworkspace") {
+				// the window arrives on the other workspace through newTarget
+				if (auto window = workspace.getFocusedWindow()) { workspace.removeWindow(window); }
+			} else {
+				skipped[record.name] += 1;
+			}
+			break;
+		}
+		case SemmetyTraceEvent::NewTarget: {
+			auto& workspace = getWorkspace(record.workspace);
+			const auto window = getWindow(record.window);
+			window->floating = record.flag;
+
+			if (window->floating) { break; }
+			if (workspace.findWindowIt(window) != workspace.windows.end()) { break; }
+
+			workspace.addWindow(window);
+			break;
+		}
+		case SemmetyTraceEvent::RemoveTarget:
+			getWorkspace(record.workspace).removeWindow(getWindow(record.window));
+			break;
+		case SemmetyTraceEvent::Focus: {
+			auto& workspace = getWorkspace(record.workspace);
+			setActiveWorkspace(record.workspace);
+
+			const auto window = getWindow(record.window);
+			window->floating = record.flag;
+			if (!window->floating) { workspace.activateWindow(window); }
+			break;
+		}
+		case SemmetyTraceEvent::Recalculate: {
+			auto& workspace = getWorkspace(record.workspace);
+			workspace.setRootGeometry(record.box);
+
+			if (record.flag) {
+				workspace.getRoot()->applyRecursive(workspace, std::nullopt, std::nullopt);
+			}
+			break;
+		}
+		case SemmetyTraceEvent::ResizeTarget: {
+			auto& workspace = getWorkspace(record.workspace);
+			if (auto frame = workspace.getFrameForWindow(getWindow(record.window))) {
+				resizeFrame(workspace, frame, record.delta, record.corner);
+			}
+			break;
+		}
+		case SemmetyTraceEvent::Hash: recordedHashes[record.workspace] = record.hash; break;
+		}
+	}
+};
+
+static uint64_t percentile(std::vector<uint64_t> values, double p) {
+	if (values.empty()) { return 0; }
+
+	std::ranges::sort(values);
+	return values[std::min(values.size() - 1, (size_t) (p * (values.size() - 1) + 0.5))];
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <trace> [--check]\n", argv[0]);
+		return 2;
+	}
+
+	const bool check = argc > 2 && std::string(argv[2]) == "--check";
+
+	SemmetyTraceReader reader;
+	if (auto error = reader.open(argv[1])) {
+		std::fprintf(stderr, "%s\n", error->c_str());
+		return 2;
+	}
+
+	CReplay replay;
+	std::map<std::string, std::vector<uint64_t>> latencies;
+	size_t events = 0;
+	size_t failures = 0;
+	uint64_t traceTime = 0;
+
+	while (auto record = reader.next()) {
+		events += 1;
+		traceTime = record->time;
+
+		const auto label = CReplay::label(*record);
+		const auto start = Clock::now();
+
+		try {
+			replay.apply(*record);
+		} catch (const std::exception& e) {
+			failures += 1;
+			std::fprintf(stderr, "event %zu (%s): %s\n", events, label.c_str(), e.what());
+		}
+
+		const auto elapsed = Clock::now() - start;
+		latencies[label].push_back(
+		    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+		);
+
+		if (!check) { continue; }
+
+		for (auto& [id, workspace]: replay.workspaces) {
+			for (const auto& error: workspace->testInvariants()) {
+				failures += 1;
+				std::fprintf(
+				    stderr,
+				    "event %zu (%s), workspace %ld: %s\n",
+				    events,
+				    label.c_str(),
+				    id,
+				    error.c_str()
+				);
+			}
+		}
+	}
+
+	if (reader.truncated) { std::fprintf(stderr, "the trace ends in a partial record\n"); }
+
+	std::printf("%zu events over %.3f s of recording\n\n", events, traceTime / 1e9);
+	std::printf(
+	    "%-28s %8s %10s %10s %10s %12s\n",
+	    "entry point",
+	    "count",
+	    "p50 us",
+	    "p99 us",
+	    "max us",
+	    "total us"
+	);
+
+	for (const auto& [label, values]: latencies) {
+		uint64_t total = 0;
+		for (const auto value: values) { total += value; }
+
+		std::printf(
+		    "%-28s %8zu %10.1f %10.1f %10.1f %12.1f\n",
+		    label.c_str(),
+		    values.size(),
+		    percentile(values, 0.5) / 1e3,
+		    percentile(values, 0.99) / 1e3,
+		    percentile(values, 1) / 1e3,
+		    total / 1e3
+		);
+	}
+
+	for (const auto& [name, count]: replay.skipped) {
+		std::printf("not replayed: semmety:%s x%zu\n", name.c_str(), count);
+	}
+
+	std::printf("\n%12s %18s %18s\n", "workspace", "replayed hash", "recorded hash");
+
+	size_t mismatches = 0;
+	for (auto& [id, workspace]: replay.workspaces) {
+		const auto hash = hashWorkspaceTree(*workspace);
+		const auto recorded = replay.recordedHashes.find(id);
+
+		if (recorded == replay.recordedHashes.end()) {
+			std::printf("%12ld %18lx %18s\n", id, hash, "-");
+			continue;
+		}
+
+		if (recorded->second != hash) { mismatches += 1; }
+		std::printf(
+		    "%12ld %18lx %18lx%s\n",
+		    id,
+		    hash,
+		    recorded->second,
+		    recorded->second == hash ? "" : " mismatch"
+		);
+	}
+
+	return failures > 0 || mismatches > 0 ? 1 : 0;
+}
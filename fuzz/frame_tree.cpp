@@ -0,0 +1,218 @@
+// libFuzzer harness that runs random sequences of split, remove, swap, focus, cycle, window order,
+// resize, add-window and remove-window on the stand-in workspace and on the reference model in
+// fuzz/reference.cpp. After every step the leaf geometry, the window in every leaf, the focused
+// frame and window and the window order have to match, and the workspace invariants have to hold.
+// A difference prints the steps so far and aborts.
+//
+// Each step is an operation byte followed by up to three argument bytes.
+//
+//   fuzz-frame-tree [corpus dir] [libFuzzer flags]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "fuzz/reference.hpp"
+#include "src/SemmetyLayoutDispatchers.hpp"
+#include "src/SemmetyStandIn.hpp"
+
+// keeps the reference's full reflows and scans cheap enough to fuzz quickly
+constexpr size_t MAX_LEAVES = 32;
+constexpr size_t MAX_WINDOWS = 32;
+
+enum class eFuzzOp : uint8_t {
+	Split,
+	Remove,
+	Swap,
+	Focus,
+	Cycle,
+	ChangeWindowOrder,
+	Resize,
+	AddWindow,
+	RemoveWindow,
+	Count,
+};
+
+static const char* directionArgs[] = {"u", "r", "d", "l"};
+
+class CFuzzInput {
+public:
+	CFuzzInput(const uint8_t* data, size_t size): data(data), size(size) {}
+
+	bool done() const { return offset >= size; }
+
+	// zero past the end, so a truncated step still runs
+	uint8_t next() { return offset < size ? data[offset++] : 0; }
+
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t offset = 0;
+};
+
+class CFuzzRun {
+public:
+	SemmetyStandInWorkspace workspace {CBox(0, 0, 1920, 1080)};
+	CReferenceLayout reference {CBox(0, 0, 1920, 1080)};
+	std::vector<std::string> steps;
+	uint64_t nextWindowId = 1;
+
+	void dispatch(const std::string& name, const std::string& args) {
+		getLayoutDispatchers().at(name)(workspace, workspace.getFocusedFrame(), CVarList(args));
+		steps.push_back(std::format("{} {}", name, args));
+	}
+
+	void step(CFuzzInput& input) {
+		const auto op = (eFuzzOp) (input.next() % (uint8_t) eFuzzOp::Count);
+		const auto arg = input.next();
+
+		switch (op) {
+		case eFuzzOp::Split:
+			if (reference.leaves().size() >= MAX_LEAVES) { return; }
+
+			dispatch("split", "");
+			reference.split();
+			break;
+		case eFuzzOp::Remove:
+			dispatch("remove", arg & 1 ? "sibling" : "");
+			reference.remove(arg & 1);
+			break;
+		case eFuzzOp::Swap:
+			dispatch("swap", directionArgs[arg % 4]);
+			reference.swap(*directionFromString(directionArgs[arg % 4]));
+			break;
+		case eFuzzOp::Focus:
+			dispatch("focus", directionArgs[arg % 4]);
+			reference.focus(*directionFromString(directionArgs[arg % 4]));
+			break;
+		case eFuzzOp::Cycle:
+			dispatch("cycle", arg & 1 ? "prev" : "next");
+			reference.cycle(arg & 1);
+			break;
+		case eFuzzOp::ChangeWindowOrder:
+			dispatch("changewindoworder", arg & 1 ? "prev" : "next");
+			reference.changeWindowOrder(arg & 1);
+			break;
+		case eFuzzOp::Resize: {
+			const auto delta = Vector2D((int8_t) input.next() * 4, (int8_t) input.next() * 4);
+			const auto corner = (ResizeCorner) (arg % 5);
+
+			resizeFrame(workspace, workspace.getFocusedFrame(), delta, corner);
+			reference.resize(delta, corner);
+			steps.push_back(std::format("resize {} {} corner {}", delta.x, delta.y, (int) corner));
+			break;
+		}
+		case eFuzzOp::AddWindow: {
+			if (reference.windows.size() >= MAX_WINDOWS) { return; }
+
+			const auto id = nextWindowId++;
+			const bool floating = arg % 4 == 0;
+
+			workspace.addWindow(SemmetyStandInWindow::create(id, floating));
+			reference.addWindow(id, floating);
+			steps.push_back(std::format("add window {}{}", id, floating ? " floating" : ""));
+			break;
+		}
+		case eFuzzOp::RemoveWindow: {
+			if (reference.windows.empty()) { return; }
+
+			const auto id = reference.windows[arg % reference.windows.size()].id;
+
+			SemmetyWindowRef window;
+			for (const auto& candidate: workspace.windows) {
+				if (candidate->id() == id) { window = candidate; }
+			}
+
+			workspace.removeWindow(window);
+			reference.removeWindow(id);
+			steps.push_back(std::format("remove window {}", id));
+
+			// the compositor moves keyboard focus off a closed window
+			if (workspace.focusedWindow == window) { workspace.focusedWindow = nullptr; }
+			if (reference.focusedWindow == id) { reference.focusedWindow = 0; }
+			break;
+		}
+		case eFuzzOp::Count: break;
+		}
+	}
+
+	std::string describeWorkspace() {
+		std::string out;
+
+		for (const auto& leaf: workspace.getRoot()->getLeafFrames()) {
+			const auto window = leaf->getWindow();
+			out += std::format(
+			    "{} {} {}x{} window {}{}\n",
+			    leaf->geometry.x,
+			    leaf->geometry.y,
+			    leaf->geometry.width,
+			    leaf->geometry.height,
+			    window ? window->id() : 0,
+			    leaf == workspace.getFocusedFrame() ? " focus" : ""
+			);
+		}
+
+		out += "windows:";
+		for (const auto& window: workspace.windows) { out += std::format(" {}", window->id()); }
+
+		const auto focused = workspace.getFocusedWindow();
+		out += std::format("\nfocused window {}\n", focused ? focused->id() : 0);
+		return out;
+	}
+
+	std::string describeReference() {
+		std::string out;
+
+		for (const auto* leaf: reference.leaves()) {
+			out += std::format(
+			    "{} {} {}x{} window {}{}\n",
+			    leaf->geometry.x,
+			    leaf->geometry.y,
+			    leaf->geometry.width,
+			    leaf->geometry.height,
+			    leaf->window,
+			    leaf == reference.focused ? " focus" : ""
+			);
+		}
+
+		out += "windows:";
+		for (const auto& window: reference.windows) { out += std::format(" {}", window.id); }
+
+		out += std::format("\nfocused window {}\n", reference.focusedWindow);
+		return out;
+	}
+
+	[[noreturn]] void fail(const std::string& what) {
+		std::fprintf(stderr, "%s after:\n", what.c_str());
+		for (const auto& step: steps) { std::fprintf(stderr, "  %s\n", step.c_str()); }
+
+		std::abort();
+	}
+
+	void check() {
+		const auto errors = workspace.testInvariants();
+		if (!errors.empty()) { fail(errors.front()); }
+
+		const auto actual = describeWorkspace();
+		const auto expected = describeReference();
+		if (actual == expected) { return; }
+
+		fail(std::format("workspace:\n{}differs from the reference:\n{}", actual, expected));
+	}
+};
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	CFuzzInput input(data, size);
+	CFuzzRun run;
+
+	while (!input.done()) {
+		run.step(input);
+		run.check();
+	}
+
+	return 0;
+}
@@ -0,0 +1,433 @@
+#include "reference.hpp"
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+static void collectLeaves(SReferenceFrame* frame, std::vector<SReferenceFrame*>& out) {
+	if (frame->isLeaf()) {
+		out.push_back(frame);
+		return;
+	}
+
+	collectLeaves(frame->first.get(), out);
+	collectLeaves(frame->second.get(), out);
+}
+
+static std::string pathString(const SReferenceFrame* frame) {
+	std::vector<int> path;
+	for (; frame->parent; frame = frame->parent) {
+		path.insert(path.begin(), frame->parent->second.get() == frame ? 1 : 0);
+	}
+
+	if (path.empty()) { return "root"; }
+
+	std::ostringstream oss;
+	for (size_t i = 0; i < path.size(); ++i) {
+		oss << path[i];
+		if (i + 1 < path.size()) { oss << "/"; }
+	}
+	return oss.str();
+}
+
+static size_t depth(const SReferenceFrame* frame) {
+	size_t result = 0;
+	for (; frame->parent; frame = frame->parent) { result += 1; }
+	return result;
+}
+
+static bool isSameOrDescendant(const SReferenceFrame* frame, const SReferenceFrame* ancestor) {
+	for (; frame; frame = frame->parent) {
+		if (frame == ancestor) { return true; }
+	}
+
+	return false;
+}
+
+static SReferenceFrame* commonAncestor(SReferenceFrame* a, SReferenceFrame* b) {
+	for (auto* frame = a; frame; frame = frame->parent) {
+		if (isSameOrDescendant(b, frame)) { return frame; }
+	}
+
+	return nullptr;
+}
+
+static double area(const SReferenceFrame* frame) {
+	return frame->geometry.width * frame->geometry.height;
+}
+
+CReferenceLayout::CReferenceLayout(CBox geometry):
+    geometry(geometry), root(std::make_unique<SReferenceFrame>()) {
+	root->geometry = geometry;
+	focused = root.get();
+}
+
+std::vector<SReferenceFrame*> CReferenceLayout::leaves() const {
+	std::vector<SReferenceFrame*> out;
+	collectLeaves(root.get(), out);
+	return out;
+}
+
+void CReferenceLayout::layout(SReferenceFrame* frame, CBox frameGeometry) {
+	frame->geometry = frameGeometry;
+
+	if (frame->isLeaf()) {
+		if (frame->window) { frame->geometry.round(); }
+		return;
+	}
+
+	const auto& box = frame->geometry;
+	if (frame->vertical) {
+		const auto firstWidth = box.width * frame->ratio;
+		const auto secondWidth = box.width * (1 - frame->ratio);
+
+		layout(frame->first.get(), CBox(box.x, box.y, firstWidth, box.height).round());
+		layout(
+		    frame->second.get(),
+		    CBox(box.x + firstWidth, box.y, secondWidth, box.height).round()
+		);
+	} else {
+		const auto firstHeight = box.height * frame->ratio;
+		const auto secondHeight = box.height * (1 - frame->ratio);
+
+		layout(frame->first.get(), CBox(box.x, box.y, box.width, firstHeight).round());
+		layout(
+		    frame->second.get(),
+		    CBox(box.x, box.y + firstHeight, box.width, secondHeight).round()
+		);
+	}
+}
+
+std::unique_ptr<SReferenceFrame>& CReferenceLayout::slotOf(SReferenceFrame* frame) {
+	if (!frame->parent) { return root; }
+
+	return frame->parent->first.get() == frame ? frame->parent->first : frame->parent->second;
+}
+
+// Puts `source` where `target` was and reflows.
+void CReferenceLayout::replace(SReferenceFrame* target, std::unique_ptr<SReferenceFrame> source) {
+	source->parent = target->parent;
+	slotOf(target) = std::move(source);
+
+	reflow();
+}
+
+void CReferenceLayout::reflow() {
+	layout(root.get(), geometry);
+
+	while (auto* frame = largestEmptyFrame()) {
+		const auto window = nextWindowForFrame(frame);
+		if (!window) { break; }
+
+		setWindow(frame, window);
+	}
+}
+
+SReferenceWindow* CReferenceLayout::findWindow(uint64_t id) {
+	for (auto& window: windows) {
+		if (window.id == id) { return &window; }
+	}
+
+	return nullptr;
+}
+
+SReferenceFrame* CReferenceLayout::frameForWindow(uint64_t id) const {
+	for (auto* leaf: leaves()) {
+		if (leaf->window == id) { return leaf; }
+	}
+
+	return nullptr;
+}
+
+// Floating windows are never hidden by the layout, tiled ones are visible while they have a frame.
+bool CReferenceLayout::isVisible(const SReferenceWindow& window) const {
+	return window.floating || frameForWindow(window.id);
+}
+
+std::optional<size_t> CReferenceLayout::windowIndex(uint64_t id) const {
+	for (size_t i = 0; i < windows.size(); i++) {
+		if (windows[i].id == id) { return i; }
+	}
+
+	return std::nullopt;
+}
+
+// The next hidden tiled window in list order, starting after the most recently focused visible
+// window unless `start` is given.
+uint64_t CReferenceLayout::nextWindow(std::optional<size_t> start, bool backward) {
+	const auto n = windows.size();
+	if (n == 0) { return 0; }
+
+	const auto advance = [&](size_t index) { return (n + index + (backward ? -1 : 1)) % n; };
+
+	size_t index;
+	if (start) {
+		index = *start % n;
+	} else {
+		size_t lastFocused = 0;
+		uint64_t stamp = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (!isVisible(windows[i]) || windows[i].lastFocused <= stamp) { continue; }
+
+			stamp = windows[i].lastFocused;
+			lastFocused = i;
+		}
+
+		index = advance(lastFocused);
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		if (!windows[index].floating && !isVisible(windows[index])) { return windows[index].id; }
+
+		index = advance(index);
+	}
+
+	return 0;
+}
+
+uint64_t CReferenceLayout::nextWindowForFrame(SReferenceFrame* frame) {
+	const auto& history = frameHistory[pathString(frame)];
+	for (auto it = history.rbegin(); it != history.rend(); ++it) {
+		if (!isVisible(*findWindow(*it))) { return *it; }
+	}
+
+	std::optional<size_t> start;
+	if (frame->window) { start = windowIndex(frame->window).value_or(windows.size()); }
+
+	return nextWindow(start, false);
+}
+
+SReferenceFrame* CReferenceLayout::largestEmptyFrame() const {
+	SReferenceFrame* largest = nullptr;
+	for (auto* leaf: leaves()) {
+		if (leaf->window) { continue; }
+		if (!largest || area(leaf) > area(largest)) { largest = leaf; }
+	}
+
+	return largest;
+}
+
+void CReferenceLayout::setWindow(SReferenceFrame* frame, uint64_t id) {
+	frame->window = id;
+	if (!id) { return; }
+
+	frame->geometry.round();
+
+	auto& history = frameHistory[pathString(frame)];
+	std::erase(history, id);
+	history.push_back(id);
+}
+
+void CReferenceLayout::putWindowInFrame(uint64_t id, SReferenceFrame* frame) {
+	const auto replaced = frame->window;
+	if (replaced == id) {
+		focusWindow(id);
+		return;
+	}
+
+	setWindow(frame, id);
+	focusWindow(id);
+
+	if (!replaced) { return; }
+
+	if (auto* empty = largestEmptyFrame()) { setWindow(empty, replaced); }
+}
+
+void CReferenceLayout::focusWindow(uint64_t id) {
+	if (focusedWindow == id) { return; }
+
+	focusedWindow = id;
+	if (auto* window = findWindow(id)) { window->lastFocused = ++focusStamp; }
+}
+
+void CReferenceLayout::setFocusedFrame(SReferenceFrame* frame) {
+	if (frame == focused) {
+		focusWindow(focused->window);
+		return;
+	}
+
+	std::vector<SReferenceFrame*> candidates;
+	collectLeaves(frame, candidates);
+
+	focused = candidates.front();
+	for (auto* leaf: candidates) {
+		if (leaf->focusOrder > focused->focusOrder) { focused = leaf; }
+	}
+
+	focused->focusOrder = ++focusOrder;
+	focusWindow(focused->window);
+}
+
+// The closest leaf past the edge of `basis` in `dir` that overlaps it on the other axis, the most
+// recently focused one if several are equally close.
+SReferenceFrame* CReferenceLayout::neighbor(SReferenceFrame* basis, Direction dir) const {
+	const bool vertical = dir == Direction::Up || dir == Direction::Down;
+	const double sign = dir == Direction::Up || dir == Direction::Left ? -1 : 1;
+
+	const auto position = [&](const SReferenceFrame* frame) {
+		return (vertical ? frame->geometry.y : frame->geometry.x) * sign;
+	};
+
+	const auto overlaps = [&](const SReferenceFrame* frame) {
+		const auto& a = basis->geometry;
+		const auto& b = frame->geometry;
+		return vertical ? std::min(a.x + a.width, b.x + b.width) > std::max(a.x, b.x)
+		                : std::min(a.y + a.height, b.y + b.height) > std::max(a.y, b.y);
+	};
+
+	SReferenceFrame* best = nullptr;
+	for (auto* leaf: leaves()) {
+		if (position(leaf) <= position(basis) || !overlaps(leaf)) { continue; }
+
+		if (!best || position(leaf) < position(best)
+		    || (position(leaf) == position(best) && leaf->focusOrder > best->focusOrder))
+		{
+			best = leaf;
+		}
+	}
+
+	return best;
+}
+
+SReferenceFrame* CReferenceLayout::resizeTarget(SReferenceFrame* frame, Direction dir) const {
+	auto* other = neighbor(frame, dir);
+	return other ? commonAncestor(frame, other) : nullptr;
+}
+
+// The split between `frame` and its neighbor on either side, the one fewer levels up if both exist.
+SReferenceFrame*
+CReferenceLayout::resizeTarget(SReferenceFrame* frame, Direction pos, Direction neg) const {
+	auto* posTarget = resizeTarget(frame, pos);
+	auto* negTarget = resizeTarget(frame, neg);
+	if (!posTarget || !negTarget) { return posTarget ? posTarget : negTarget; }
+
+	const auto distance = [&](SReferenceFrame* ancestor, Direction dir) {
+		return depth(frame) + depth(neighbor(frame, dir)) - 2 * depth(ancestor);
+	};
+
+	return distance(posTarget, pos) > distance(negTarget, neg) ? negTarget : posTarget;
+}
+
+void CReferenceLayout::split() {
+	auto* leaf = focused;
+
+	auto frame = std::make_unique<SReferenceFrame>();
+	auto* split = frame.get();
+	split->geometry = leaf->geometry;
+	split->vertical = leaf->geometry.width > leaf->geometry.height;
+	split->parent = leaf->parent;
+	split->second = std::make_unique<SReferenceFrame>();
+	split->second->parent = split;
+
+	// the split takes the leaf's place and the leaf becomes its first child
+	split->first = std::exchange(slotOf(leaf), std::move(frame));
+	leaf->parent = split;
+
+	reflow();
+	setFocusedFrame(split->second.get());
+}
+
+bool CReferenceLayout::remove(bool sibling) {
+	auto* parent = focused->parent;
+	if (!parent) { return false; }
+
+	const bool focusedIsFirst = parent->first.get() == focused;
+	auto& kept = sibling == focusedIsFirst ? parent->first : parent->second;
+	auto* remaining = kept.get();
+
+	replace(parent, std::move(kept));
+
+	if (!sibling) { setFocusedFrame(remaining); }
+	return true;
+}
+
+void CReferenceLayout::swap(Direction dir) {
+	auto* other = neighbor(focused, dir);
+	if (!other) { return; }
+
+	const auto window = focused->window;
+	setWindow(focused, other->window);
+	setWindow(other, window);
+	setFocusedFrame(other);
+}
+
+void CReferenceLayout::focus(Direction dir) {
+	if (auto* other = neighbor(focused, dir)) { setFocusedFrame(other); }
+}
+
+void CReferenceLayout::cycle(bool prev) {
+	if (const auto window = nextWindow(std::nullopt, prev)) { putWindowInFrame(window, focused); }
+}
+
+void CReferenceLayout::changeWindowOrder(bool prev) {
+	const auto n = windows.size();
+	if (n < 2 || !focusedWindow) { return; }
+
+	const auto index = *windowIndex(focusedWindow);
+	const auto window = windows[index];
+
+	windows.erase(windows.begin() + index);
+	windows.insert(windows.begin() + (index + (prev ? n - 1 : 1)) % n, window);
+}
+
+void CReferenceLayout::resize(Vector2D delta, ResizeCorner corner) {
+	SReferenceFrame* horizontal = nullptr;
+	SReferenceFrame* vertical = nullptr;
+
+	switch (corner) {
+	case ResizeCorner::TopLeft:
+		horizontal = resizeTarget(focused, Direction::Left);
+		vertical = resizeTarget(focused, Direction::Up);
+		delta = Vector2D(-delta.x, -delta.y);
+		break;
+	case ResizeCorner::TopRight:
+		horizontal = resizeTarget(focused, Direction::Right);
+		vertical = resizeTarget(focused, Direction::Up);
+		delta.y *= -1;
+		break;
+	case ResizeCorner::BottomRight:
+		horizontal = resizeTarget(focused, Direction::Right);
+		vertical = resizeTarget(focused, Direction::Down);
+		break;
+	case ResizeCorner::BottomLeft:
+		horizontal = resizeTarget(focused, Direction::Left);
+		vertical = resizeTarget(focused, Direction::Down);
+		delta.x *= -1;
+		break;
+	case ResizeCorner::None:
+		horizontal = resizeTarget(focused, Direction::Left, Direction::Right);
+		vertical = resizeTarget(focused, Direction::Up, Direction::Down);
+		break;
+	}
+
+	// both ratios are computed from the geometry before either resize is laid out
+	const auto resizeSplit = [&](SReferenceFrame* split, double distance) {
+		if (isSameOrDescendant(focused, split->second.get())) { distance *= -1; }
+
+		const auto& first = split->first->geometry;
+		const double size = split->vertical ? first.width : first.height;
+		const double total = split->vertical ? split->geometry.width : split->geometry.height;
+		split->ratio = std::clamp((size + distance) / total, 0.1, 0.9);
+	};
+
+	if (horizontal) { resizeSplit(horizontal, delta.x); }
+	if (vertical) { resizeSplit(vertical, delta.y); }
+
+	layout(root.get(), geometry);
+}
+
+void CReferenceLayout::addWindow(uint64_t id, bool floating) {
+	windows.push_back({.id = id, .floating = floating});
+	if (!floating) { putWindowInFrame(id, focused); }
+}
+
+void CReferenceLayout::removeWindow(uint64_t id) {
+	for (auto& [path, history]: frameHistory) { std::erase(history, id); }
+
+	if (auto* frame = frameForWindow(id)) {
+		const auto next = nextWindowForFrame(frame);
+		setWindow(frame, next);
+		if (next && frame == focused) { focusWindow(next); }
+	}
+
+	if (const auto index = windowIndex(id)) { windows.erase(windows.begin() + *index); }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Vector2D.hpp>
+
+#include "src/SemmetyFrameUtils.hpp"
+
+// A straightforward model of what the layout core does, for the differential fuzzer. Nothing is
+// cached: geometry is laid out from the root after every change, paths and leaves are walked when
+// needed and windows are found by scanning. Windows are plain ids, the stand-in's focus stamps are
+// modelled by `lastFocused`.
+
+struct SReferenceFrame {
+	CBox geometry;
+	int focusOrder = 0;
+	uint64_t window = 0;
+
+	// split frames only, `vertical` is SplitV (children side by side)
+	bool vertical = false;
+	float ratio = 0.5;
+	std::unique_ptr<SReferenceFrame> first;
+	std::unique_ptr<SReferenceFrame> second;
+	SReferenceFrame* parent = nullptr;
+
+	bool isLeaf() const { return !first; }
+};
+
+struct SReferenceWindow {
+	uint64_t id = 0;
+	bool floating = false;
+	uint64_t lastFocused = 0;
+};
+
+class CReferenceLayout {
+public:
+	explicit CReferenceLayout(CBox geometry);
+
+	CBox geometry;
+	std::unique_ptr<SReferenceFrame> root;
+	SReferenceFrame* focused = nullptr;
+	std::vector<SReferenceWindow> windows;
+	uint64_t focusedWindow = 0;
+
+	void split();
+	// false for the root, which cannot be removed
+	bool remove(bool sibling);
+	void swap(Direction dir);
+	void focus(Direction dir);
+	void cycle(bool prev);
+	void changeWindowOrder(bool prev);
+	void resize(Vector2D delta, ResizeCorner corner);
+	void addWindow(uint64_t id, bool floating);
+	void removeWindow(uint64_t id);
+
+	std::vector<SReferenceFrame*> leaves() const;
+
+private:
+	std::map<std::string, std::vector<uint64_t>> frameHistory;
+	int focusOrder = 0;
+	uint64_t focusStamp = 0;
+
+	void layout(SReferenceFrame* frame, CBox frameGeometry);
+	void replace(SReferenceFrame* target, std::unique_ptr<SReferenceFrame> source);
+	// Lays everything out from the root and fills the empty frames from their history, largest
+	// first.
+	void reflow();
+	std::unique_ptr<SReferenceFrame>& slotOf(SReferenceFrame* frame);
+
+	SReferenceWindow* findWindow(uint64_t id);
+	SReferenceFrame* frameForWindow(uint64_t id) const;
+	bool isVisible(const SReferenceWindow& window) const;
+	std::optional<size_t> windowIndex(uint64_t id) const;
+	uint64_t nextWindow(std::optional<size_t> start, bool backward);
+	uint64_t nextWindowForFrame(SReferenceFrame* frame);
+	SReferenceFrame* largestEmptyFrame() const;
+
+	void setWindow(SReferenceFrame* frame, uint64_t id);
+	void putWindowInFrame(uint64_t id, SReferenceFrame* frame);
+	void focusWindow(uint64_t id);
+	void setFocusedFrame(SReferenceFrame* frame);
+
+	SReferenceFrame* neighbor(SReferenceFrame* basis, Direction dir) const;
+	SReferenceFrame* resizeTarget(SReferenceFrame* frame, Direction dir) const;
+	SReferenceFrame* resizeTarget(SReferenceFrame* frame, Direction pos, Direction neg) const;
+};
@@ -0,0 +1,121 @@
+#include "SemmetyAllocStats.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+//
+// SemmetyAllocStats
+//
+
+void SemmetyAllocStats::record(
+    eSemmetyAllocTable table,
+    std::string_view name,
+    SemmetyAllocCount count
+) {
+	std::lock_guard lock(m_mutex);
+
+	auto& entries = table == eSemmetyAllocTable::Hook ? m_hooks : m_entryPoints;
+	auto it = entries.find(name);
+	if (it == entries.end()) { it = entries.emplace(name, SEntry {}).first; }
+
+	auto& entry = it->second;
+	entry.count += 1;
+	entry.allocations += count.allocations;
+	entry.bytes += count.bytes;
+	entry.maxAllocations = std::max(entry.maxAllocations, count.allocations);
+	if (count.allocations > 0) { entry.allocatingCount += 1; }
+}
+
+void SemmetyAllocStats::reset() {
+	std::lock_guard lock(m_mutex);
+	m_entryPoints.clear();
+	m_hooks.clear();
+}
+
+json SemmetyAllocStats::toJson(eSemmetyAllocTable table) const {
+	std::lock_guard lock(m_mutex);
+
+	json out = json::object();
+	for (const auto& [name, entry]: table == eSemmetyAllocTable::Hook ? m_hooks : m_entryPoints) {
+		out[name] = {
+		    {"count", entry.count},
+		    {"allocations", entry.allocations},
+		    {"bytes", entry.bytes},
+		    {"maxAllocations", entry.maxAllocations},
+		    {"allocatingCount", entry.allocatingCount},
+		};
+	}
+
+	return out;
+}
+
+//
+// Counting operator new
+//
+
+#ifdef SEMMETY_ALLOC_STATS
+
+// The plugin is linked with -Bsymbolic-functions in this mode, so semmety's own calls bind to these
+// while the compositor keeps libstdc++'s. The memory comes from malloc like libstdc++'s, so either
+// side may free what the other allocated.
+
+static void* countedAlloc(size_t size, size_t alignment) {
+	t_semmetyAllocs.allocations += 1;
+	t_semmetyAllocs.bytes += size;
+
+	if (size == 0) { size = 1; }
+	if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) { return std::malloc(size); }
+
+	// aligned_alloc needs a size that is a multiple of the alignment
+	return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+static void* countedAllocOrThrow(size_t size, size_t alignment) {
+	auto* ptr = countedAlloc(size, alignment);
+	if (ptr == nullptr) { throw std::bad_alloc(); }
+	return ptr;
+}
+
+void* operator new(size_t size) { return countedAllocOrThrow(size, 0); }
+void* operator new[](size_t size) { return countedAllocOrThrow(size, 0); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+	return countedAllocOrThrow(size, (size_t) alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+	return countedAllocOrThrow(size, (size_t) alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size, 0); }
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return countedAlloc(size, (size_t) alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return countedAlloc(size, (size_t) alignment);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+	std::free(ptr);
+}
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+// Heap allocations made through operator new on one thread. Only counted when built with
+// -Dalloc_stats=true, which replaces operator new for semmety's own code (see
+// SemmetyAllocStats.cpp). Allocations inside Hyprland functions semmety calls are not counted.
+struct SemmetyAllocCount {
+	uint64_t allocations = 0;
+	uint64_t bytes = 0;
+};
+
+inline thread_local SemmetyAllocCount t_semmetyAllocs;
+
+enum class eSemmetyAllocTable {
+	EntryPoint,
+	Hook,
+};
+
+// Allocations per entryWrapper() entry point and per compositor hook, recorded on the compositor
+// thread and read by the socket's allocs command on the I/O thread.
+class SemmetyAllocStats {
+public:
+#ifdef SEMMETY_ALLOC_STATS
+	static constexpr bool ENABLED = true;
+#else
+	static constexpr bool ENABLED = false;
+#endif
+
+	void record(eSemmetyAllocTable table, std::string_view name, SemmetyAllocCount count);
+	void reset();
+	// {name: {"count", "allocations", "bytes", "maxAllocations", "allocatingCount"}}, where
+	// allocatingCount is how many of the calls allocated at all.
+	json toJson(eSemmetyAllocTable table) const;
+
+private:
+	struct SEntry {
+		uint64_t count = 0;
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+		uint64_t maxAllocations = 0;
+		uint64_t allocatingCount = 0;
+	};
+
+	// looks names up without building a std::string, which would be counted itself
+	struct SNameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+	};
+
+	using Entries = std::unordered_map<std::string, SEntry, SNameHash, std::equal_to<>>;
+
+	mutable std::mutex m_mutex;
+	Entries m_entryPoints;
+	Entries m_hooks;
+};
+
+inline SemmetyAllocStats g_semmetyAllocStats;
+
+// Records the allocations the calling thread makes during the scope. Does nothing unless
+// SemmetyAllocStats::ENABLED.
+class SemmetyAllocScope {
+public:
+	SemmetyAllocScope(std::string_view name, eSemmetyAllocTable table):
+	    m_name(name), m_table(table), m_start(t_semmetyAllocs) {}
+
+	~SemmetyAllocScope() {
+		if constexpr (!SemmetyAllocStats::ENABLED) { return; }
+
+		const auto end = t_semmetyAllocs;
+		g_semmetyAllocStats.record(
+		    m_table,
+		    m_name,
+		    {
+		        .allocations = end.allocations - m_start.allocations,
+		        .bytes = end.bytes - m_start.bytes,
+		    }
+		);
+	}
+
+	SemmetyAllocScope(const SemmetyAllocScope&) = delete;
+	SemmetyAllocScope& operator=(const SemmetyAllocScope&) = delete;
+
+private:
+	std::string_view m_name;
+	eSemmetyAllocTable m_table;
+	SemmetyAllocCount m_start;
+};
@@ -0,0 +1,716 @@
+#include "SemmetyBarState.hpp"
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
+
+json barWindowToJson(const SemmetyBarWindow& window) {
+	return {
+	    {"address", window.address},
+	    {"urgent", window.urgent},
+	    {"title", window.title},
+	    {"appid", window.appid},
+	    {"focused", window.focused},
+	    {"minimized", window.minimized},
+	};
+}
+
+json barWorkspaceToJson(const SemmetyBarWorkspace& workspace) {
+	return {
+	    {"id", workspace.id},
+	    {"numWindows", workspace.numWindows},
+	    {"name", workspace.name},
+	    {"monitor", workspace.monitor},
+	    {"urgent", workspace.urgent},
+	    {"focused", workspace.focused},
+	    {"visible", workspace.visible},
+	};
+}
+
+json barFocusToJson(const SemmetyBarFocus& focus) {
+	return {
+	    {"window", focus.window},
+	    {"frame", focus.frame},
+	    {"monitor", focus.monitor},
+	    {"workspace", focus.workspace},
+	};
+}
+
+json barFrameToJson(const SemmetyBarFrame& frame) {
+	return {
+	    {"path", frame.path},
+	    {"window", frame.window},
+	    {"x", frame.x},
+	    {"y", frame.y},
+	    {"width", frame.width},
+	    {"height", frame.height},
+	    {"focused", frame.focused},
+	};
+}
+
+std::optional<eSemmetyBarTopic> barTopicFromString(std::string_view name) {
+	if (name == "windows") { return BAR_TOPIC_WINDOWS; }
+	if (name == "workspaces") { return BAR_TOPIC_WORKSPACES; }
+	if (name == "focus") { return BAR_TOPIC_FOCUS; }
+	if (name == "frames") { return BAR_TOPIC_FRAMES; }
+	return std::nullopt;
+}
+
+bool barTopicsChanged(
+    const SemmetyBarState& prev,
+    const SemmetyBarState& next,
+    SemmetyBarTopics topics
+) {
+	topics &= prev.gathered & next.gathered;
+	return ((topics & BAR_TOPIC_WINDOWS) && prev.windows != next.windows)
+	    || ((topics & BAR_TOPIC_WORKSPACES) && prev.workspaces != next.workspaces)
+	    || ((topics & BAR_TOPIC_FOCUS) && prev.focus != next.focus)
+	    || ((topics & BAR_TOPIC_FRAMES) && prev.frames != next.frames)
+	    || ((topics & BAR_TOPIC_MONITORS) && prev.monitors != next.monitors);
+}
+
+SemmetyBarState barMonitorView(const SemmetyBarState& state, std::string_view monitor) {
+	SemmetyBarState view {.focus = state.focus, .frames = state.frames};
+
+	view.gathered = state.gathered & (BAR_TOPIC_FOCUS | BAR_TOPIC_FRAMES);
+	if (state.gathered & BAR_TOPIC_MONITORS) {
+		view.gathered |= BAR_TOPIC_WINDOWS | BAR_TOPIC_WORKSPACES | BAR_TOPIC_MONITORS;
+	}
+
+	const auto it = std::ranges::find(state.monitors, monitor, &SemmetyBarMonitor::name);
+	if (it != state.monitors.end()) {
+		view.windows = it->windows;
+		view.workspaces = it->workspaces;
+	}
+
+	return view;
+}
+
+static json barWindowsToJson(const std::vector<SemmetyBarWindowPtr>& windows) {
+	json jsonWindows = json::array();
+	for (const auto& window: windows) { jsonWindows.push_back(barWindowToJson(*window)); }
+	return jsonWindows;
+}
+
+static json barWorkspacesToJson(const std::vector<SemmetyBarWorkspace>& workspaces) {
+	json jsonWorkspaces = json::array();
+	for (const auto& workspace: workspaces) {
+		jsonWorkspaces.push_back(barWorkspaceToJson(workspace));
+	}
+	return jsonWorkspaces;
+}
+
+static json barFramesToJson(const std::vector<SemmetyBarFrame>& frames) {
+	json jsonFrames = json::array();
+	for (const auto& frame: frames) { jsonFrames.push_back(barFrameToJson(frame)); }
+	return jsonFrames;
+}
+
+json barStateToJson(const SemmetyBarState& state, SemmetyBarTopics topics) {
+	json document = json::object();
+	if (topics & BAR_TOPIC_WINDOWS) { document["windows"] = barWindowsToJson(state.windows); }
+	if (topics & BAR_TOPIC_WORKSPACES) {
+		document["workspaces"] = barWorkspacesToJson(state.workspaces);
+	}
+	if (topics & BAR_TOPIC_FOCUS) { document["focus"] = barFocusToJson(state.focus); }
+	if (topics & BAR_TOPIC_FRAMES) { document["frames"] = barFramesToJson(state.frames); }
+	return document;
+}
+
+json barUpdateJson(
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	auto update = barStateToJson(state, topics);
+	update["seq"] = stamp.seq;
+	update["time"] = stamp.time;
+	return update;
+}
+
+json barSnapshotJson(
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	auto snapshot = barUpdateJson(state, stamp, topics);
+	snapshot["type"] = "snapshot";
+	return snapshot;
+}
+
+// Diffs two keyed collections. Records are matched on key; a matched record that compares unequal
+// is reported in full as an update.
+template <typename T, typename KeyFn, typename ToJsonFn>
+static json diffRecords(
+    const std::vector<T>& prev,
+    const std::vector<T>& next,
+    KeyFn key,
+    ToJsonFn toJson
+) {
+	std::unordered_map<decltype(key(prev.front())), const T*> prevByKey;
+	prevByKey.reserve(prev.size());
+	for (const auto& record: prev) { prevByKey.emplace(key(record), &record); }
+
+	json added = json::array();
+	json updated = json::array();
+	for (const auto& record: next) {
+		auto it = prevByKey.find(key(record));
+		if (it == prevByKey.end()) {
+			added.push_back(toJson(record));
+			continue;
+		}
+
+		if (!(*it->second == record)) { updated.push_back(toJson(record)); }
+		prevByKey.erase(it);
+	}
+
+	json removed = json::array();
+	for (const auto& record: prev) {
+		if (prevByKey.contains(key(record))) { removed.push_back(key(record)); }
+	}
+
+	json section = json::object();
+	if (!added.empty()) { section["add"] = std::move(added); }
+	if (!removed.empty()) { section["remove"] = std::move(removed); }
+	if (!updated.empty()) { section["update"] = std::move(updated); }
+	return section;
+}
+
+static json barWindowsDelta(
+    const std::vector<SemmetyBarWindowPtr>& prev,
+    const std::vector<SemmetyBarWindowPtr>& next
+) {
+	auto windows = diffRecords(
+	    prev,
+	    next,
+	    [](const SemmetyBarWindowPtr& window) -> std::string_view { return window->address; },
+	    [](const SemmetyBarWindowPtr& window) { return barWindowToJson(*window); }
+	);
+
+	const bool orderChanged = !std::equal(
+	    prev.begin(),
+	    prev.end(),
+	    next.begin(),
+	    next.end(),
+	    [](const auto& a, const auto& b) { return a->address == b->address; }
+	);
+
+	if (orderChanged) {
+		json order = json::array();
+		for (const auto& window: next) { order.push_back(window->address); }
+		windows["order"] = std::move(order);
+	}
+
+	return windows;
+}
+
+std::optional<json> barDeltaJson(
+    const SemmetyBarState& prev,
+    const SemmetyBarState& next,
+    const SemmetyBarStamp& stamp,
+    uint64_t base,
+    SemmetyBarTopics topics
+) {
+	topics &= prev.gathered & next.gathered;
+	if (!barTopicsChanged(prev, next, topics)) { return std::nullopt; }
+
+	json delta = {{"type", "delta"}, {"seq", stamp.seq}, {"time", stamp.time}, {"base", base}};
+
+	if (topics & BAR_TOPIC_WINDOWS) {
+		auto windows = barWindowsDelta(prev.windows, next.windows);
+		if (!windows.empty()) { delta["windows"] = std::move(windows); }
+	}
+
+	if (topics & BAR_TOPIC_WORKSPACES) {
+		auto workspaces = diffRecords(
+		    prev.workspaces,
+		    next.workspaces,
+		    [](const SemmetyBarWorkspace& workspace) { return workspace.id; },
+		    barWorkspaceToJson
+		);
+		if (!workspaces.empty()) { delta["workspaces"] = std::move(workspaces); }
+	}
+
+	if ((topics & BAR_TOPIC_FOCUS) && prev.focus != next.focus) {
+		delta["focus"] = barFocusToJson(next.focus);
+	}
+
+	if ((topics & BAR_TOPIC_FRAMES) && prev.frames != next.frames) {
+		delta["frames"] = barFramesToJson(next.frames);
+	}
+
+	return delta;
+}
+
+// Length of the valid UTF-8 sequence at the start of `str`, or 0 if it is not valid.
+static size_t utf8SequenceLength(std::string_view str) {
+	const auto byte = [&](size_t i) { return static_cast<unsigned char>(str[i]); };
+	const auto continuation = [&](size_t i, unsigned char lo = 0x80, unsigned char hi = 0xBF) {
+		return i < str.size() && byte(i) >= lo && byte(i) <= hi;
+	};
+
+	const auto lead = byte(0);
+	if (lead >= 0xC2 && lead <= 0xDF) { return continuation(1) ? 2 : 0; }
+
+	if (lead >= 0xE0 && lead <= 0xEF) {
+		const unsigned char lo = lead == 0xE0 ? 0xA0 : 0x80;
+		const unsigned char hi = lead == 0xED ? 0x9F : 0xBF;
+		return continuation(1, lo, hi) && continuation(2) ? 3 : 0;
+	}
+
+	if (lead >= 0xF0 && lead <= 0xF4) {
+		const unsigned char lo = lead == 0xF0 ? 0x90 : 0x80;
+		const unsigned char hi = lead == 0xF4 ? 0x8F : 0xBF;
+		return continuation(1, lo, hi) && continuation(2) && continuation(3) ? 4 : 0;
+	}
+
+	return 0;
+}
+
+void appendJsonString(std::string& out, std::string_view str) {
+	static constexpr char HEX[] = "0123456789abcdef";
+
+	out += '"';
+
+	size_t i = 0;
+	while (i < str.size()) {
+		// copy runs of characters that need no escaping in one go
+		const auto runStart = i;
+		while (i < str.size()) {
+			const auto c = static_cast<unsigned char>(str[i]);
+			if (c < 0x20 || c == '"' || c == '\\' || c >= 0x80) { break; }
+			i += 1;
+		}
+		out.append(str.data() + runStart, i - runStart);
+
+		if (i == str.size()) { break; }
+
+		const auto c = static_cast<unsigned char>(str[i]);
+		if (c >= 0x80) {
+			const auto len = utf8SequenceLength(str.substr(i));
+			if (len == 0) {
+				out += "\xEF\xBF\xBD";
+				i += 1;
+			} else {
+				out.append(str.data() + i, len);
+				i += len;
+			}
+
+			continue;
+		}
+
+		switch (c) {
+		case '\b': out += "\\b"; break;
+		case '\t': out += "\\t"; break;
+		case '\n': out += "\\n"; break;
+		case '\f': out += "\\f"; break;
+		case '\r': out += "\\r"; break;
+		case '"': out += "\\\""; break;
+		case '\\': out += "\\\\"; break;
+		default:
+			out += "\\u00";
+			out += HEX[c >> 4];
+			out += HEX[c & 0xF];
+			break;
+		}
+
+		i += 1;
+	}
+
+	out += '"';
+}
+
+static void appendBool(std::string& out, bool value) { out += value ? "true" : "false"; }
+
+template <typename T>
+static void appendNumber(std::string& out, T value) {
+	char buffer[24];
+	const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, result.ptr);
+}
+
+// Keys are written in the order nlohmann's (sorted) object type dumps them.
+static void writeUncachedBarWindowJson(std::string& out, const SemmetyBarWindow& window) {
+	out += "{\"address\":";
+	appendJsonString(out, window.address);
+	out += ",\"appid\":";
+	appendJsonString(out, window.appid);
+	out += ",\"focused\":";
+	appendBool(out, window.focused);
+	out += ",\"minimized\":";
+	appendBool(out, window.minimized);
+	out += ",\"title\":";
+	appendJsonString(out, window.title);
+	out += ",\"urgent\":";
+	appendBool(out, window.urgent);
+	out += '}';
+}
+
+static void writeBarWindowJson(std::string& out, const SemmetyBarWindowPtr& window) {
+	if (window->jsonFragment.empty()) {
+		writeUncachedBarWindowJson(out, *window);
+	} else {
+		out += window->jsonFragment;
+	}
+}
+
+std::string barWindowJsonFragment(const SemmetyBarWindow& window) {
+	std::string out;
+	writeUncachedBarWindowJson(out, window);
+	return out;
+}
+
+static void writeBarWorkspaceJson(std::string& out, const SemmetyBarWorkspace& workspace) {
+	out += "{\"focused\":";
+	appendBool(out, workspace.focused);
+	out += ",\"id\":";
+	appendNumber(out, workspace.id);
+	out += ",\"monitor\":";
+	appendJsonString(out, workspace.monitor);
+	out += ",\"name\":";
+	appendJsonString(out, workspace.name);
+	out += ",\"numWindows\":";
+	appendNumber(out, workspace.numWindows);
+	out += ",\"urgent\":";
+	appendBool(out, workspace.urgent);
+	out += ",\"visible\":";
+	appendBool(out, workspace.visible);
+	out += '}';
+}
+
+static void writeBarFocusJson(std::string& out, const SemmetyBarFocus& focus) {
+	out += "{\"frame\":";
+	appendJsonString(out, focus.frame);
+	out += ",\"monitor\":";
+	appendJsonString(out, focus.monitor);
+	out += ",\"window\":";
+	appendJsonString(out, focus.window);
+	out += ",\"workspace\":";
+	appendNumber(out, focus.workspace);
+	out += '}';
+}
+
+static void writeBarFrameJson(std::string& out, const SemmetyBarFrame& frame) {
+	out += "{\"focused\":";
+	appendBool(out, frame.focused);
+	out += ",\"height\":";
+	appendNumber(out, frame.height);
+	out += ",\"path\":";
+	appendJsonString(out, frame.path);
+	out += ",\"width\":";
+	appendNumber(out, frame.width);
+	out += ",\"window\":";
+	appendJsonString(out, frame.window);
+	out += ",\"x\":";
+	appendNumber(out, frame.x);
+	out += ",\"y\":";
+	appendNumber(out, frame.y);
+	out += '}';
+}
+
+template <typename T, typename WriteFn>
+static void writeJsonArray(std::string& out, const std::vector<T>& records, WriteFn write) {
+	out += '[';
+	for (size_t i = 0; i < records.size(); i++) {
+		if (i != 0) { out += ','; }
+		write(out, records[i]);
+	}
+	out += ']';
+}
+
+// Writes the members for `topics`, plus "seq" and "time" when `stamp` is set and "type" when `type`
+// is, in sorted key order.
+static void writeBarDocumentJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    SemmetyBarTopics topics,
+    const SemmetyBarStamp* stamp,
+    std::string_view type
+) {
+	bool first = true;
+	const auto key = [&](std::string_view name) {
+		out += first ? "{\"" : ",\"";
+		out += name;
+		out += "\":";
+		first = false;
+	};
+
+	if (topics & BAR_TOPIC_FOCUS) {
+		key("focus");
+		writeBarFocusJson(out, state.focus);
+	}
+
+	if (topics & BAR_TOPIC_FRAMES) {
+		key("frames");
+		writeJsonArray(out, state.frames, writeBarFrameJson);
+	}
+
+	if (stamp) {
+		key("seq");
+		appendNumber(out, stamp->seq);
+		key("time");
+		appendNumber(out, stamp->time);
+	}
+
+	if (!type.empty()) {
+		key("type");
+		appendJsonString(out, type);
+	}
+
+	if (topics & BAR_TOPIC_WINDOWS) {
+		key("windows");
+		writeJsonArray(out, state.windows, writeBarWindowJson);
+	}
+
+	if (topics & BAR_TOPIC_WORKSPACES) {
+		key("workspaces");
+		writeJsonArray(out, state.workspaces, writeBarWorkspaceJson);
+	}
+
+	out += first ? "{}" : "}";
+}
+
+void writeBarStateJson(std::string& out, const SemmetyBarState& state, SemmetyBarTopics topics) {
+	writeBarDocumentJson(out, state, topics, nullptr, {});
+}
+
+void writeBarUpdateJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	writeBarDocumentJson(out, state, topics, &stamp, {});
+}
+
+void writeBarSnapshotJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	writeBarDocumentJson(out, state, topics, &stamp, "snapshot");
+}
+
+static void appendBigEndian(std::string& out, uint64_t value, size_t bytes) {
+	for (size_t i = bytes; i > 0; i--) { out += static_cast<char>((value >> ((i - 1) * 8)) & 0xFF); }
+}
+
+static void appendMsgpackUnsigned(std::string& out, uint64_t value) {
+	if (value < 0x80) {
+		out += static_cast<char>(value);
+	} else if (value <= UINT8_MAX) {
+		out += '\xCC';
+		appendBigEndian(out, value, 1);
+	} else if (value <= UINT16_MAX) {
+		out += '\xCD';
+		appendBigEndian(out, value, 2);
+	} else if (value <= UINT32_MAX) {
+		out += '\xCE';
+		appendBigEndian(out, value, 4);
+	} else {
+		out += '\xCF';
+		appendBigEndian(out, value, 8);
+	}
+}
+
+static void appendMsgpackInteger(std::string& out, int64_t value) {
+	if (value >= 0) {
+		appendMsgpackUnsigned(out, value);
+	} else if (value >= -32) {
+		out += static_cast<char>(value);
+	} else if (value >= INT8_MIN) {
+		out += '\xD0';
+		appendBigEndian(out, value, 1);
+	} else if (value >= INT16_MIN) {
+		out += '\xD1';
+		appendBigEndian(out, value, 2);
+	} else if (value >= INT32_MIN) {
+		out += '\xD2';
+		appendBigEndian(out, value, 4);
+	} else {
+		out += '\xD3';
+		appendBigEndian(out, value, 8);
+	}
+}
+
+static void appendMsgpackBool(std::string& out, bool value) { out += value ? '\xC3' : '\xC2'; }
+
+static void appendMsgpackString(std::string& out, std::string_view str) {
+	if (str.size() <= 31) {
+		out += static_cast<char>(0xA0 | str.size());
+	} else if (str.size() <= UINT8_MAX) {
+		out += '\xD9';
+		appendBigEndian(out, str.size(), 1);
+	} else if (str.size() <= UINT16_MAX) {
+		out += '\xDA';
+		appendBigEndian(out, str.size(), 2);
+	} else {
+		out += '\xDB';
+		appendBigEndian(out, str.size(), 4);
+	}
+
+	out += str;
+}
+
+static void appendMsgpackContainer(std::string& out, size_t size, bool isMap) {
+	if (size <= 15) {
+		out += static_cast<char>((isMap ? 0x80 : 0x90) | size);
+	} else if (size <= UINT16_MAX) {
+		out += isMap ? '\xDE' : '\xDC';
+		appendBigEndian(out, size, 2);
+	} else {
+		out += isMap ? '\xDF' : '\xDD';
+		appendBigEndian(out, size, 4);
+	}
+}
+
+static void writeBarWindowMsgpack(std::string& out, const SemmetyBarWindowPtr& window) {
+	appendMsgpackContainer(out, 6, true);
+	appendMsgpackString(out, "address");
+	appendMsgpackString(out, window->address);
+	appendMsgpackString(out, "appid");
+	appendMsgpackString(out, window->appid);
+	appendMsgpackString(out, "focused");
+	appendMsgpackBool(out, window->focused);
+	appendMsgpackString(out, "minimized");
+	appendMsgpackBool(out, window->minimized);
+	appendMsgpackString(out, "title");
+	appendMsgpackString(out, window->title);
+	appendMsgpackString(out, "urgent");
+	appendMsgpackBool(out, window->urgent);
+}
+
+static void writeBarWorkspaceMsgpack(std::string& out, const SemmetyBarWorkspace& workspace) {
+	appendMsgpackContainer(out, 7, true);
+	appendMsgpackString(out, "focused");
+	appendMsgpackBool(out, workspace.focused);
+	appendMsgpackString(out, "id");
+	appendMsgpackInteger(out, workspace.id);
+	appendMsgpackString(out, "monitor");
+	appendMsgpackString(out, workspace.monitor);
+	appendMsgpackString(out, "name");
+	appendMsgpackString(out, workspace.name);
+	appendMsgpackString(out, "numWindows");
+	appendMsgpackUnsigned(out, workspace.numWindows);
+	appendMsgpackString(out, "urgent");
+	appendMsgpackBool(out, workspace.urgent);
+	appendMsgpackString(out, "visible");
+	appendMsgpackBool(out, workspace.visible);
+}
+
+static void writeBarFocusMsgpack(std::string& out, const SemmetyBarFocus& focus) {
+	appendMsgpackContainer(out, 4, true);
+	appendMsgpackString(out, "frame");
+	appendMsgpackString(out, focus.frame);
+	appendMsgpackString(out, "monitor");
+	appendMsgpackString(out, focus.monitor);
+	appendMsgpackString(out, "window");
+	appendMsgpackString(out, focus.window);
+	appendMsgpackString(out, "workspace");
+	appendMsgpackInteger(out, focus.workspace);
+}
+
+static void writeBarFrameMsgpack(std::string& out, const SemmetyBarFrame& frame) {
+	appendMsgpackContainer(out, 7, true);
+	appendMsgpackString(out, "focused");
+	appendMsgpackBool(out, frame.focused);
+	appendMsgpackString(out, "height");
+	appendMsgpackInteger(out, frame.height);
+	appendMsgpackString(out, "path");
+	appendMsgpackString(out, frame.path);
+	appendMsgpackString(out, "width");
+	appendMsgpackInteger(out, frame.width);
+	appendMsgpackString(out, "window");
+	appendMsgpackString(out, frame.window);
+	appendMsgpackString(out, "x");
+	appendMsgpackInteger(out, frame.x);
+	appendMsgpackString(out, "y");
+	appendMsgpackInteger(out, frame.y);
+}
+
+template <typename T, typename WriteFn>
+static void writeMsgpackArray(std::string& out, const std::vector<T>& records, WriteFn write) {
+	appendMsgpackContainer(out, records.size(), false);
+	for (const auto& record: records) { write(out, record); }
+}
+
+static void writeBarDocumentMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    SemmetyBarTopics topics,
+    const SemmetyBarStamp* stamp,
+    std::string_view type
+) {
+	topics &= BAR_TOPICS_ALL;
+	const auto members = std::popcount(topics) + (stamp ? 2 : 0) + (type.empty() ? 0 : 1);
+	appendMsgpackContainer(out, members, true);
+
+	if (topics & BAR_TOPIC_FOCUS) {
+		appendMsgpackString(out, "focus");
+		writeBarFocusMsgpack(out, state.focus);
+	}
+
+	if (topics & BAR_TOPIC_FRAMES) {
+		appendMsgpackString(out, "frames");
+		writeMsgpackArray(out, state.frames, writeBarFrameMsgpack);
+	}
+
+	if (stamp) {
+		appendMsgpackString(out, "seq");
+		appendMsgpackUnsigned(out, stamp->seq);
+		appendMsgpackString(out, "time");
+		appendMsgpackUnsigned(out, stamp->time);
+	}
+
+	if (!type.empty()) {
+		appendMsgpackString(out, "type");
+		appendMsgpackString(out, type);
+	}
+
+	if (topics & BAR_TOPIC_WINDOWS) {
+		appendMsgpackString(out, "windows");
+		writeMsgpackArray(out, state.windows, writeBarWindowMsgpack);
+	}
+
+	if (topics & BAR_TOPIC_WORKSPACES) {
+		appendMsgpackString(out, "workspaces");
+		writeMsgpackArray(out, state.workspaces, writeBarWorkspaceMsgpack);
+	}
+}
+
+void writeBarStateMsgpack(std::string& out, const SemmetyBarState& state, SemmetyBarTopics topics) {
+	writeBarDocumentMsgpack(out, state, topics, nullptr, {});
+}
+
+void writeBarUpdateMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	writeBarDocumentMsgpack(out, state, topics, &stamp, {});
+}
+
+void writeBarSnapshotMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics
+) {
+	writeBarDocumentMsgpack(out, state, topics, &stamp, "snapshot");
+}
+
+size_t beginBinaryFrame(std::string& out) {
+	const auto frameStart = out.size();
+	out.append(4, '\0');
+	return frameStart;
+}
+
+void finishBinaryFrame(std::string& out, size_t frameStart) {
+	const auto length = static_cast<uint32_t>(out.size() - frameStart - 4);
+	for (size_t i = 0; i < 4; i++) {
+		out[frameStart + i] = static_cast<char>((length >> (i * 8)) & 0xFF);
+	}
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+// Plain copy of everything the bar stream publishes. updateBar() fills this from the compositor
+// state, and the event manager keeps the last published one so that diff-mode clients can be sent
+// only what changed without touching any Hyprland objects again.
+
+struct SemmetyBarWindow {
+	std::string address;
+	std::string title;
+	std::string appid;
+	bool urgent = false;
+	bool focused = false;
+	bool minimized = false;
+	// The JSON object for this window, written as is by the streaming writers when set. Workspace
+	// wrappers keep it next to the fields and only rebuild it when one of them changed.
+	std::string jsonFragment;
+
+	bool operator==(const SemmetyBarWindow&) const = default;
+};
+
+// A published window. The workspace wrapper that built it and every state published since share
+// one immutable record, a change makes a new record, so gathering and queueing a state copies no
+// window. Compares by value.
+class SemmetyBarWindowPtr {
+public:
+	SemmetyBarWindowPtr(SemmetyBarWindow window):
+	    m_window(std::make_shared<const SemmetyBarWindow>(std::move(window))) {}
+
+	const SemmetyBarWindow& operator*() const { return *m_window; }
+	const SemmetyBarWindow* operator->() const { return m_window.get(); }
+
+	bool operator==(const SemmetyBarWindowPtr& other) const {
+		return m_window == other.m_window || *m_window == *other.m_window;
+	}
+
+private:
+	std::shared_ptr<const SemmetyBarWindow> m_window;
+};
+
+struct SemmetyBarWorkspace {
+	int id = 0;
+	std::string name;
+	std::string monitor;
+	size_t numWindows = 0;
+	bool focused = false; // where actions go: the focused monitor's special workspace if open,
+	                      // its active workspace otherwise
+	bool visible = false; // shown on its monitor
+	bool urgent = false;
+
+	bool operator==(const SemmetyBarWorkspace&) const = default;
+};
+
+struct SemmetyBarFocus {
+	std::string window; // address of the focused window, empty if there is none
+	std::string frame;  // path of the focused frame
+	std::string monitor;
+	int workspace = 0;
+
+	bool operator==(const SemmetyBarFocus&) const = default;
+};
+
+// A leaf frame of the focused workspace.
+struct SemmetyBarFrame {
+	std::string path;
+	std::string window; // empty for an empty frame
+	int x = 0;
+	int y = 0;
+	int width = 0;
+	int height = 0;
+	bool focused = false;
+
+	bool operator==(const SemmetyBarFrame&) const = default;
+};
+
+// The view of one monitor, for clients that follow a monitor rather than the focus.
+struct SemmetyBarMonitor {
+	std::string name;
+	std::vector<SemmetyBarWindowPtr> windows;    // of the workspace shown on the monitor
+	std::vector<SemmetyBarWorkspace> workspaces; // on the monitor
+
+	bool operator==(const SemmetyBarMonitor&) const = default;
+};
+
+// Each topic is one member of the published document. Clients subscribe to a subset, and only the
+// topics some client wants are gathered and serialized.
+enum eSemmetyBarTopic : uint8_t {
+	BAR_TOPIC_WINDOWS = 1 << 0,    // "windows": windows of the focused workspace
+	BAR_TOPIC_WORKSPACES = 1 << 1, // "workspaces": see plugin:semmety:bar_workspaces
+	BAR_TOPIC_FOCUS = 1 << 2,      // "focus": focused window, frame, workspace and monitor
+	BAR_TOPIC_FRAMES = 1 << 3,     // "frames": leaf frames of the focused workspace, no splits
+	// Never sent itself. Gathers the per-monitor views that barMonitorView() takes windows and
+	// workspaces from.
+	BAR_TOPIC_MONITORS = 1 << 4,
+};
+
+using SemmetyBarTopics = uint8_t;
+
+constexpr SemmetyBarTopics BAR_TOPICS_DEFAULT = BAR_TOPIC_WINDOWS | BAR_TOPIC_WORKSPACES;
+constexpr SemmetyBarTopics BAR_TOPICS_ALL =
+    BAR_TOPIC_WINDOWS | BAR_TOPIC_WORKSPACES | BAR_TOPIC_FOCUS | BAR_TOPIC_FRAMES;
+
+std::optional<eSemmetyBarTopic> barTopicFromString(std::string_view name);
+
+// Topics that were not gathered are left empty, `gathered` says which ones were.
+struct SemmetyBarState {
+	std::vector<SemmetyBarWindowPtr> windows;
+	std::vector<SemmetyBarWorkspace> workspaces;
+	SemmetyBarFocus focus;
+	std::vector<SemmetyBarFrame> frames;
+	std::vector<SemmetyBarMonitor> monitors;
+	SemmetyBarTopics gathered = 0;
+
+	bool operator==(const SemmetyBarState&) const = default;
+};
+
+// What a client following `monitor` sees: that monitor's windows and workspaces in place of the
+// focused ones, the other topics as they are in `state`.
+SemmetyBarState barMonitorView(const SemmetyBarState& state, std::string_view monitor);
+
+// Identifies a published update. seq grows by one with every update, time is when the compositor
+// published it (CLOCK_MONOTONIC, in microseconds).
+struct SemmetyBarStamp {
+	uint64_t seq = 0;
+	uint64_t time = 0;
+};
+
+// True if any of `topics` differs between the two states. Only topics gathered in both are
+// compared, an empty topic that was not gathered says nothing about the compositor.
+bool barTopicsChanged(
+    const SemmetyBarState& prev,
+    const SemmetyBarState& next,
+    SemmetyBarTopics topics
+);
+
+json barWindowToJson(const SemmetyBarWindow& window);
+// What writeBarStateJson() writes for `window`, ignoring its jsonFragment.
+std::string barWindowJsonFragment(const SemmetyBarWindow& window);
+json barWorkspaceToJson(const SemmetyBarWorkspace& workspace);
+json barFocusToJson(const SemmetyBarFocus& focus);
+json barFrameToJson(const SemmetyBarFrame& frame);
+
+// {"windows": [...], "workspaces": [...]}, with one member per topic.
+json barStateToJson(const SemmetyBarState& state, SemmetyBarTopics topics = BAR_TOPICS_DEFAULT);
+
+// {"seq": N, "time": T, "windows": [...], "workspaces": [...]}, the payload sent to full-mode
+// clients.
+json barUpdateJson(
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+
+// {"type": "snapshot", "seq": N, "time": T, "windows": [...], "workspaces": [...]}
+json barSnapshotJson(
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+
+// Streaming counterparts of the functions above, writeBarStateJson(out, state) appends exactly
+// barStateToJson(state).dump() to `out` without building a json DOM, and so on. The only
+// difference is that invalid UTF-8 is replaced with U+FFFD where nlohmann would throw.
+void writeBarStateJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+void writeBarUpdateJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+void writeBarSnapshotJson(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+
+// Appends `str` as a quoted, escaped JSON string, matching nlohmann's dump() escaping.
+void appendJsonString(std::string& out, std::string_view str);
+
+// MessagePack encodings of the same documents, byte-for-byte what json::to_msgpack() gives for
+// the json ones.
+void writeBarStateMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+void writeBarUpdateMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+void writeBarSnapshotMsgpack(
+    std::string& out,
+    const SemmetyBarState& state,
+    const SemmetyBarStamp& stamp,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
+
+// Binary framing: a 4 byte little-endian payload length followed by the payload. Returns the frame
+// start to pass to finishBinaryFrame() once the payload has been appended.
+size_t beginBinaryFrame(std::string& out);
+void finishBinaryFrame(std::string& out, size_t frameStart);
+
+// {"type": "delta", "seq": N, "time": T, "base": B, "windows": {...}, "workspaces": {...}} where
+// each section holds "add" and "update" (full records), "remove" (window addresses / workspace ids)
+// and, for windows, "order" (all addresses) when the window order changed. "focus" and "frames"
+// are small and are sent whole when they changed. Unchanged sections are omitted. `base` is the seq
+// of the last update that changed any of `topics`, the delta applies to a state at least that new.
+// Returns nullopt when none of `topics` changed. As in barTopicsChanged(), topics not gathered in
+// both states are left out.
+std::optional<json> barDeltaJson(
+    const SemmetyBarState& prev,
+    const SemmetyBarState& next,
+    const SemmetyBarStamp& stamp,
+    uint64_t base,
+    SemmetyBarTopics topics = BAR_TOPICS_DEFAULT
+);
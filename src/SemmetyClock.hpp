@@ -0,0 +1,10 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// CLOCK_MONOTONIC in nanoseconds, the clock of the latency stats and the span trace.
+inline uint64_t semmetyMonotonicNs() {
+	const auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <format>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+// Called with the message before semmety_critical_error() throws. The plugin logs it together with
+// the call stack and the layout state.
+inline std::function<void(const std::string&)> g_semmetyCriticalErrorHook;
+
+// For states the layout should never get into.
+template <typename... Args>
+[[noreturn]] void semmety_critical_error(std::format_string<Args...> fmt, Args&&... args) {
+	auto msg = std::vformat(fmt.get(), std::make_format_args(args...));
+
+	if (g_semmetyCriticalErrorHook) { g_semmetyCriticalErrorHook(msg); }
+	throw std::runtime_error("[semmety] " + msg);
+}
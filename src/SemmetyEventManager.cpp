@@ -1,71 +1,167 @@
 #include "SemmetyEventManager.hpp"
 #include <algorithm>
 #include <cstring>
+#include <list>
 
 #include <hyprland/src/Compositor.hpp>
-#include "log.hpp"
+#include <hyprland/src/debug/log/Logger.hpp>
 #include <netinet/in.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "SemmetyAllocStats.hpp"
+#include "SemmetyLatencyStats.hpp"
+#include "SemmetyPerfCounters.hpp"
+#include "SemmetySpans.hpp"
+#include "log.hpp"
+
 using namespace Hyprutils::OS;
 
-SemmetyEventManager::SemmetyEventManager():
-    m_iSocketFD(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)) {
+SemmetyEventManager::SemmetyEventManager(std::function<void()> publish):
+    m_iSocketFD(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0)),
+    m_publish(std::move(publish)) {
 	if (!m_iSocketFD.isValid()) {
-		Log::logger->log(Log::ERR, "Couldn't start the Hyprland Socket 2. (1) IPC will not work.");
+		semmety_log(Ipc, Log::ERR, "Couldn't start the Hyprland Socket 2. (1) IPC will not work.");
 		return;
 	}
 
 	sockaddr_un SERVERADDRESS = {.sun_family = AF_UNIX};
 	const auto PATH = g_pCompositor->m_instancePath + "/.semmety-socket2.sock";
 	if (PATH.length() > sizeof(SERVERADDRESS.sun_path) - 1) {
-		Log::logger->log(Log::ERR, "Socket2 path is too long. (2) IPC will not work.");
+		semmety_log(Ipc, Log::ERR, "Socket2 path is too long. (2) IPC will not work.");
 		return;
 	}
 
 	strncpy(SERVERADDRESS.sun_path, PATH.c_str(), sizeof(SERVERADDRESS.sun_path) - 1);
 
 	if (bind(m_iSocketFD.get(), (sockaddr*) &SERVERADDRESS, SUN_LEN(&SERVERADDRESS)) < 0) {
-		Log::logger->log(Log::ERR, "Couldn't bind the Hyprland Socket 2. (3) IPC will not work.");
+		semmety_log(Ipc, Log::ERR, "Couldn't bind the Hyprland Socket 2. (3) IPC will not work.");
 		return;
 	}
 
 	// 10 max queued.
 	if (listen(m_iSocketFD.get(), 10) < 0) {
-		Log::logger->log(Log::ERR, "Couldn't listen on the Hyprland Socket 2. (4) IPC will not work.");
+		semmety_log(Ipc, Log::ERR, "Couldn't listen on the Hyprland Socket 2. (4) IPC will not work.");
+		return;
+	}
+
+	m_iWakeupFD = CFileDescriptor {eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+	m_iPublishRequestFD = CFileDescriptor {eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)};
+	m_pEventLoop = wl_event_loop_create();
+	if (!m_iWakeupFD.isValid() || !m_iPublishRequestFD.isValid() || m_pEventLoop == nullptr) {
+		semmety_log(Ipc, Log::ERR, "Couldn't create the Socket2 event loop. (5) IPC will not work.");
 		return;
 	}
 
 	m_pEventSource = wl_event_loop_add_fd(
-	    g_pCompositor->m_wlEventLoop,
+	    m_pEventLoop,
 	    m_iSocketFD.get(),
 	    WL_EVENT_READABLE,
-	    onClientEvent,
-	    nullptr
+	    onServerEvent,
+	    this
 	);
+	m_pWakeupSource =
+	    wl_event_loop_add_fd(m_pEventLoop, m_iWakeupFD.get(), WL_EVENT_READABLE, onWakeup, this);
+
+	m_pPublishRequestSource = wl_event_loop_add_fd(
+	    g_pCompositor->m_wlEventLoop,
+	    m_iPublishRequestFD.get(),
+	    WL_EVENT_READABLE,
+	    onPublishRequest,
+	    this
+	);
+
+	m_thread = std::thread([this] { run(); });
+	pthread_setname_np(m_thread.native_handle(), "semmety-ipc");
 }
 
 SemmetyEventManager::~SemmetyEventManager() {
+	if (m_thread.joinable()) {
+		m_bStopping.store(true, std::memory_order_release);
+		eventfd_write(m_iWakeupFD.get(), 1);
+		m_thread.join();
+	}
+
+	if (m_pPublishRequestSource != nullptr) wl_event_source_remove(m_pPublishRequestSource);
+
+	// the I/O thread is gone, its event loop can be torn down from here
 	for (const auto& client: m_vClients) { wl_event_source_remove(client.eventSource); }
 
+	if (m_pWakeupSource != nullptr) wl_event_source_remove(m_pWakeupSource);
 	if (m_pEventSource != nullptr) wl_event_source_remove(m_pEventSource);
+	if (m_pEventLoop != nullptr) wl_event_loop_destroy(m_pEventLoop);
 }
 
 int SemmetyEventManager::onServerEvent(int fd, uint32_t mask, void* data) {
-	return g_SemmetyEventManager->onClientEvent(fd, mask);
+	return static_cast<SemmetyEventManager*>(data)->onServerEvent(fd, mask);
 }
 
 int SemmetyEventManager::onClientEvent(int fd, uint32_t mask, void* data) {
-	return g_SemmetyEventManager->onServerEvent(fd, mask);
+	return static_cast<SemmetyEventManager*>(data)->onClientEvent(fd, mask);
+}
+
+void SemmetyEventManager::run() {
+	g_semmetySpans.nameThread("semmety-ipc");
+
+	while (!m_bStopping.load(std::memory_order_acquire)) {
+		wl_event_loop_dispatch(m_pEventLoop, -1);
+	}
+}
+
+int SemmetyEventManager::onWakeup(int fd, uint32_t mask, void* data) {
+	auto* self = static_cast<SemmetyEventManager*>(data);
+
+	eventfd_t count;
+	eventfd_read(fd, &count);
+
+	std::optional<SemmetyBarUpdate> latest;
+	while (auto update = self->m_updates.pop()) { latest = std::move(update); }
+
+	if (latest) { self->publishBarState(std::move(*latest)); }
+
+	// there is room again, let the compositor send what it had to drop
+	if (self->m_bUpdatesDropped.exchange(false, std::memory_order_acq_rel)) {
+		self->requestPublish();
+	}
+
+	return 0;
+}
+
+// Compositor thread: a client asked for state, publish it with the next idle.
+int SemmetyEventManager::onPublishRequest(int fd, uint32_t mask, void* data) {
+	eventfd_t count;
+	eventfd_read(fd, &count);
+
+	static_cast<SemmetyEventManager*>(data)->m_publish();
+	return 0;
+}
+
+void SemmetyEventManager::requestPublish() {
+	// the compositor gathers what wantedTopics() says, so it has to be current first
+	updateWantedTopics();
+	eventfd_write(m_iPublishRequestFD.get(), 1);
+}
+
+void SemmetyEventManager::updateWantedTopics() {
+	SemmetyBarTopics topics = 0;
+	for (const auto& client: m_vClients) {
+		topics |= client.topics | client.pendingSnapshot;
+		if (client.mode == eSemmetyBarMode::Shared) { topics |= BAR_TOPICS_DEFAULT; }
+		if (!client.monitor.empty()) { topics |= BAR_TOPIC_MONITORS; }
+	}
+
+	m_wantedTopics.store(topics, std::memory_order_relaxed);
 }
 
 int SemmetyEventManager::onServerEvent(int fd, uint32_t mask) {
 	if (mask & WL_EVENT_ERROR || mask & WL_EVENT_HANGUP) {
-		Log::logger->log(Log::ERR, "Socket2 hangup?? IPC broke");
+		semmety_log(Ipc, Log::ERR, "Socket2 hangup?? IPC broke");
 
 		wl_event_source_remove(m_pEventSource);
 		m_pEventSource = nullptr;
@@ -84,7 +180,7 @@ int SemmetyEventManager::onServerEvent(int fd, uint32_t mask) {
 	)};
 	if (!ACCEPTEDCONNECTION.isValid()) {
 		if (errno != EAGAIN) {
-			Log::logger->log(Log::ERR, "Socket2 failed receiving connection, errno: {}", errno);
+			semmety_log(Ipc, Log::ERR, "Socket2 failed receiving connection, errno: {}", errno);
 			wl_event_source_remove(m_pEventSource);
 			m_pEventSource = nullptr;
 			m_iSocketFD.reset();
@@ -93,15 +189,15 @@ int SemmetyEventManager::onServerEvent(int fd, uint32_t mask) {
 		return 0;
 	}
 
-	Log::logger->log(Log::INFO, "Socket2 accepted a new client at FD {}", ACCEPTEDCONNECTION.get());
+	semmety_log(Ipc, Log::INFO, "Socket2 accepted a new client at FD {}", ACCEPTEDCONNECTION.get());
 
 	// add to event loop so we can close it when we need to
 	auto* eventSource = wl_event_loop_add_fd(
-	    g_pCompositor->m_wlEventLoop,
+	    m_pEventLoop,
 	    ACCEPTEDCONNECTION.get(),
-	    0,
-	    onServerEvent,
-	    nullptr
+	    WL_EVENT_READABLE,
+	    onClientEvent,
+	    this
 	);
 	m_vClients.emplace_back(
 	    SClient {
@@ -111,34 +207,297 @@ int SemmetyEventManager::onServerEvent(int fd, uint32_t mask) {
 	    }
 	);
 
+	updateWantedTopics();
 	return 0;
 }
 
 int SemmetyEventManager::onClientEvent(int fd, uint32_t mask) {
 	if (mask & WL_EVENT_ERROR || mask & WL_EVENT_HANGUP) {
-		Log::logger->log(Log::INFO, "Socket2 fd {} hung up", fd);
+		semmety_log(Ipc, Log::INFO, "Socket2 fd {} hung up", fd);
 		removeClientByFD(fd);
 		return 0;
 	}
 
-	if (mask & WL_EVENT_WRITABLE) {
-		const auto CLIENTIT = findClientByFD(fd);
+	const auto CLIENTIT = findClientByFD(fd);
+	if (CLIENTIT == m_vClients.end()) { return 0; }
 
-		// send all queued events
-		while (!CLIENTIT->events.empty()) {
-			const auto& event = CLIENTIT->events.front();
-			if (write(CLIENTIT->fd.get(), event->c_str(), event->length()) < 0) break;
+	if (mask & WL_EVENT_READABLE) {
+		if (!readClientCommands(*CLIENTIT)) {
+			removeClientByFD(fd);
+			return 0;
+		}
+	}
 
-			CLIENTIT->events.erase(CLIENTIT->events.begin());
+	if (mask & WL_EVENT_WRITABLE) {
+		// send as many queued events as the socket takes
+		if (!CLIENTIT->events.flush(fd)) {
+			semmety_log(Ipc, Log::ERR, "Socket2 fd {} write failed, errno: {}", fd, errno);
+			removeClientByFD(fd);
+			return 0;
 		}
 
 		// stop polling when we sent all events
-		if (CLIENTIT->events.empty()) wl_event_source_fd_update(CLIENTIT->eventSource, 0);
+		if (CLIENTIT->events.empty()) {
+			wl_event_source_fd_update(CLIENTIT->eventSource, WL_EVENT_READABLE);
+		}
 	}
 
 	return 0;
 }
 
+// Returns false if the client hung up or misbehaved and should be removed.
+bool SemmetyEventManager::readClientCommands(SClient& client) {
+	const size_t MAX_COMMAND_LENGTH = 1024;
+
+	char buffer[MAX_COMMAND_LENGTH];
+	while (true) {
+		const auto len = read(client.fd.get(), buffer, sizeof(buffer));
+		if (len == 0) { return false; }
+		if (len < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+
+		client.readBuffer.append(buffer, len);
+	}
+
+	size_t newline;
+	while ((newline = client.readBuffer.find('\n')) != std::string::npos) {
+		const auto command = client.readBuffer.substr(0, newline);
+		client.readBuffer.erase(0, newline + 1);
+
+		if (!handleClientCommand(client, command)) { return false; }
+	}
+
+	if (client.readBuffer.length() > MAX_COMMAND_LENGTH) {
+		semmety_log(Ipc, Log::ERR, "Socket2 fd {} sent an oversized command", client.fd.get());
+		return false;
+	}
+
+	return true;
+}
+
+bool SemmetyEventManager::handleClientCommand(SClient& client, std::string_view command) {
+	if (command.ends_with('\r')) { command.remove_suffix(1); }
+
+	if (command == "mode full") {
+		client.mode = eSemmetyBarMode::Full;
+		return true;
+	}
+
+	if (command == "mode diff") {
+		client.mode = eSemmetyBarMode::Diff;
+
+		// diff clients start from a snapshot, every following update is a delta against it
+		client.pendingSnapshot |= client.topics;
+		requestPublish();
+		return true;
+	}
+
+	if (command == "mode shm") {
+		if (!ensureSharedState()) { return true; }
+
+		client.mode = eSemmetyBarMode::Shared;
+
+		// the region may hold an older state than the client has seen, refresh it
+		requestPublish();
+		return sendToClient(
+		    client,
+		    encodeJson(client.encoding, sharedStateJson()),
+		    m_pSharedState->fd()
+		);
+	}
+
+	if (command == "stats") { return sendToClient(client, encodeJson(client.encoding, statsJson())); }
+
+	if (command == "stats reset") {
+		g_semmetyLatencyStats.reset();
+		return true;
+	}
+
+	if (command == "allocs") {
+		const json reply = {
+		    {"type", "allocs"},
+		    {"seq", m_barStamp.seq},
+		    {"time", m_barStamp.time},
+		    {"enabled", SemmetyAllocStats::ENABLED},
+		    {"entryPoints", g_semmetyAllocStats.toJson(eSemmetyAllocTable::EntryPoint)},
+		    {"hooks", g_semmetyAllocStats.toJson(eSemmetyAllocTable::Hook)},
+		};
+
+		return sendToClient(client, encodeJson(client.encoding, reply));
+	}
+
+	if (command == "allocs reset") {
+		g_semmetyAllocStats.reset();
+		return true;
+	}
+
+	if (command == "perf") {
+		auto reply = g_semmetyPerf.toJson();
+		reply["type"] = "perf";
+		reply["seq"] = m_barStamp.seq;
+		reply["time"] = m_barStamp.time;
+
+		return sendToClient(client, encodeJson(client.encoding, reply));
+	}
+
+	if (command == "perf reset") {
+		g_semmetyPerf.reset();
+		return true;
+	}
+
+	if (command == "monitor" || command.starts_with("monitor ")) {
+		command.remove_prefix(std::string_view("monitor").size());
+		while (command.starts_with(' ')) { command.remove_prefix(1); }
+		client.monitor = command;
+
+		// the client's view changed under it
+		client.pendingSnapshot |= client.topics;
+		requestPublish();
+		return true;
+	}
+
+	if (command == "subscribe" || command.starts_with("subscribe ")) {
+		command.remove_prefix(std::string_view("subscribe").size());
+		const auto topics = parseTopics(client, command);
+		if (!topics) { return true; }
+
+		client.topics = *topics;
+		client.subscribed = true;
+		client.pendingSnapshot |= *topics;
+		requestPublish();
+		return true;
+	}
+
+	if (command == "snapshot" || command.starts_with("snapshot ")) {
+		command.remove_prefix(std::string_view("snapshot").size());
+		const auto topics = command.empty() ? client.topics : parseTopics(client, command);
+		if (!topics) { return true; }
+
+		client.pendingSnapshot |= *topics;
+		requestPublish();
+		return true;
+	}
+
+	if (command == "encoding json") {
+		client.encoding = eSemmetyBarEncoding::Json;
+		return true;
+	}
+
+	if (command == "encoding msgpack") {
+		client.encoding = eSemmetyBarEncoding::MsgPack;
+		return true;
+	}
+
+	if (command == "backpressure conflate") {
+		client.backpressure = eSemmetyBackpressure::Conflate;
+		return true;
+	}
+
+	if (command == "backpressure disconnect") {
+		client.backpressure = eSemmetyBackpressure::Disconnect;
+		return true;
+	}
+
+	semmety_log(Ipc, Log::WARN, "Socket2 fd {} sent unknown command '{}'", client.fd.get(), command);
+	return true;
+}
+
+// Parses a space separated topic list. Logs and returns nullopt if it is empty or has an unknown
+// topic.
+std::optional<SemmetyBarTopics>
+SemmetyEventManager::parseTopics(const SClient& client, std::string_view list) {
+	SemmetyBarTopics topics = 0;
+
+	while (!list.empty()) {
+		const auto space = list.find(' ');
+		const auto name = list.substr(0, space);
+		list.remove_prefix(space == std::string_view::npos ? list.size() : space + 1);
+		if (name.empty()) { continue; }
+
+		const auto topic = barTopicFromString(name);
+		if (!topic) {
+			semmety_log(Ipc, Log::WARN, "Socket2 fd {} sent unknown topic '{}'", client.fd.get(), name);
+			return std::nullopt;
+		}
+
+		topics |= *topic;
+	}
+
+	if (topics == 0) {
+		semmety_log(Ipc, Log::WARN, "Socket2 fd {} sent an empty topic list", client.fd.get());
+		return std::nullopt;
+	}
+
+	return topics;
+}
+
+bool SemmetyEventManager::ensureSharedState() {
+	if (m_pSharedState) { return true; }
+
+	const size_t INITIAL_SIZE = 64 * 1024;
+	auto sharedState = makeUnique<SemmetySharedState>(
+	    std::max(INITIAL_SIZE, SemmetySharedState::requiredSize(m_lastBarState) * 2)
+	);
+	if (!sharedState->valid()) {
+		semmety_log(Ipc, Log::ERR, "Socket2 couldn't create the shared state, errno: {}", errno);
+		return false;
+	}
+
+	sharedState->write(m_lastBarState, m_barStamp.seq);
+	m_pSharedState = std::move(sharedState);
+	return true;
+}
+
+json SemmetyEventManager::sharedStateJson() const {
+	return {
+	    {"type", "shm"},
+	    {"size", m_pSharedState->size()},
+	    {"seq", m_barStamp.seq},
+	    {"time", m_barStamp.time},
+	};
+}
+
+json SemmetyEventManager::statsJson() const {
+	json clients = json::array();
+	for (const auto& client: m_vClients) {
+		clients.push_back({
+		    {"fd", client.fd.get()},
+		    {"mode", (int) client.mode},
+		    {"encoding", (int) client.encoding},
+		    {"topics", client.topics},
+		    {"queued", client.events.size()},
+		    {"queuedBytes", client.events.queuedBytes()},
+		    {"conflated", client.conflatedEvents},
+		    {"lastQueuedSeq", client.lastQueuedSeq},
+		    {"lastDeliveredSeq", client.events.lastWrittenSeq()},
+		    {"bytesWritten", client.events.bytesWritten()},
+		});
+	}
+
+	return {
+	    {"type", "stats"},
+	    {"seq", m_barStamp.seq},
+	    {"time", m_barStamp.time},
+	    {"droppedUpdates", m_iDroppedUpdates.load(std::memory_order_relaxed)},
+	    {"clients", std::move(clients)},
+	    {"entryPoints", g_semmetyLatencyStats.toJson()},
+	};
+}
+
+SP<std::string> SemmetyEventManager::encodeJson(eSemmetyBarEncoding encoding, const json& message) {
+	// window titles need not be valid UTF-8, and a throwing dump() would end the I/O thread
+	return encodeMessage(
+	    encoding,
+	    [&](std::string& out) {
+		    out += message.dump(-1, ' ', false, json::error_handler_t::replace);
+	    },
+	    [&](std::string& out) { json::to_msgpack(message, out); }
+	);
+}
+
 std::vector<SemmetyEventManager::SClient>::iterator SemmetyEventManager::findClientByFD(int fd) {
 	return std::find_if(m_vClients.begin(), m_vClients.end(), [fd](const auto& client) {
 		return client.fd.get() == fd;
@@ -149,37 +508,342 @@ std::vector<SemmetyEventManager::SClient>::iterator SemmetyEventManager::removeC
 	const auto CLIENTIT = findClientByFD(fd);
 	wl_event_source_remove(CLIENTIT->eventSource);
 
-	return m_vClients.erase(CLIENTIT);
+	auto next = m_vClients.erase(CLIENTIT);
+	updateWantedTopics();
+	return next;
+}
+
+// Writes one message: newline terminated for json, length prefixed for binary clients. The result
+// can be queued for any number of clients. `sizeHint` is reserved up front and set to the size
+// written.
+template <typename JsonFn, typename MsgpackFn>
+SP<std::string> SemmetyEventManager::encodeMessage(
+    eSemmetyBarEncoding encoding,
+    JsonFn&& writeJson,
+    MsgpackFn&& writeMsgpack,
+    size_t* sizeHint
+) {
+	auto message = makeShared<std::string>();
+	auto& out = *message;
+	if (sizeHint) { out.reserve(*sizeHint); }
+
+	switch (encoding) {
+	case eSemmetyBarEncoding::Json:
+		writeJson(out);
+		out += '\n';
+		break;
+	case eSemmetyBarEncoding::MsgPack: {
+		const auto frameStart = beginBinaryFrame(out);
+		writeMsgpack(out);
+		finishBinaryFrame(out, frameStart);
+		break;
+	}
+	}
+
+	if (sizeHint) { *sizeHint = out.size(); }
+	return message;
+}
+
+// Returns false if the client overflowed its event queue or its socket failed, and should be
+// removed.
+bool SemmetyEventManager::sendToClient(
+    SClient& client,
+    const SP<std::string>& event,
+    SP<Hyprutils::OS::CFileDescriptor> fd,
+    bool replaceable
+) {
+	const bool WASEMPTY = client.events.empty();
+	client.lastQueuedSeq = m_barStamp.seq;
+
+	if (!client.events.push(event, m_barStamp.seq, std::move(fd), replaceable)) {
+		// too many events queued, remove the client
+		semmety_log(Ipc, Log::ERR, "Socket2 fd {} overflowed event queue, removing", client.fd.get());
+		return false;
+	}
+
+	// while events are already queued the socket is polled for write and flushed from there
+	if (!WASEMPTY) { return true; }
+
+	// try to send the event immediately
+	if (!client.events.flush(client.fd.get())) {
+		semmety_log(Ipc, Log::ERR, "Socket2 fd {} write failed, errno: {}", client.fd.get(), errno);
+		return false;
+	}
+
+	// poll for write if the socket did not take all of it
+	if (!client.events.empty()) {
+		wl_event_source_fd_update(client.eventSource, WL_EVENT_READABLE | WL_EVENT_WRITABLE);
+	}
+
+	return true;
 }
 
-void SemmetyEventManager::postBarUpdate(std::string updateJson) {
+void SemmetyEventManager::postBarUpdate(SemmetyBarState state) {
 	if (g_pCompositor->m_isShuttingDown) {
-		Log::logger->log(Log::WARN, "Suppressed (shutting down) postBarUpdate event");
+		semmety_log(Ipc, Log::WARN, "Suppressed (shutting down) postBarUpdate event");
 		return;
 	}
 
-	const size_t MAX_QUEUED_EVENTS = 64;
-	auto sharedUpdateJson = makeShared<std::string>(updateJson + "\n");
+	if (!m_thread.joinable()) { return; }
+
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	SemmetyBarUpdate update {
+	    .state = std::move(state),
+	    .time = (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000,
+	};
+
+	if (!m_updates.push(std::move(update))) {
+		m_iDroppedUpdates.fetch_add(1, std::memory_order_relaxed);
+		m_bUpdatesDropped.store(true, std::memory_order_release);
+	}
+
+	// also on a drop, the I/O thread may have drained the queue before seeing the flag
+	eventfd_write(m_iWakeupFD.get(), 1);
+}
+
+void SemmetyEventManager::publishBarState(SemmetyBarUpdate update) {
+	const SemmetySpan span("publishBarState");
+
+	auto& state = update.state;
+	m_barStamp = {.seq = m_barStamp.seq + 1, .time = update.time};
+
+	// Clients see either the focused view or the view of the monitor they follow. Monitor views are
+	// only built for monitors that have clients.
+	struct SView {
+		const SemmetyBarState& prev;
+		const SemmetyBarState& next;
+		std::array<uint64_t, 8>& topicSeqs;
+		uint64_t index;
+	};
+
+	std::list<SemmetyBarState> monitorStates;
+	std::unordered_map<std::string, SView> views;
+	views.emplace("", SView {m_lastBarState, state, m_viewTopicSeqs[""], 0});
+
+	const auto viewFor = [&](const SClient& client) -> const SView& {
+		if (const auto it = views.find(client.monitor); it != views.end()) { return it->second; }
+
+		const auto& prev = monitorStates.emplace_back(barMonitorView(m_lastBarState, client.monitor));
+		const auto& next = monitorStates.emplace_back(barMonitorView(state, client.monitor));
+		const SView view {prev, next, m_viewTopicSeqs[client.monitor], views.size()};
+		return views.emplace(client.monitor, view).first->second;
+	};
+
+	// A delta over some topics applies to any state newer than the last change to one of them.
+	const auto baseFor = [&](const SView& view, SemmetyBarTopics topics) {
+		uint64_t base = 0;
+		for (size_t bit = 0; bit < view.topicSeqs.size(); bit++) {
+			if (topics & (1 << bit)) { base = std::max(base, view.topicSeqs[bit]); }
+		}
+		return base;
+	};
+
+	// The shared region is rewritten once per update, shm clients are only told that it changed.
+	// When the state outgrows it, it is replaced by a larger one that is sent to them instead.
+	const bool SHAREDCLIENTS = std::ranges::any_of(m_vClients, [](const auto& client) {
+		return client.mode == eSemmetyBarMode::Shared;
+	});
+	// the region may hold topics the last state didn't gather, it can't be compared against
+	const bool SHAREDSTALE = (m_lastBarState.gathered & BAR_TOPICS_DEFAULT) != BAR_TOPICS_DEFAULT;
+	const bool SHAREDCHANGED =
+	    m_pSharedState && SHAREDCLIENTS
+	    && (SHAREDSTALE || barTopicsChanged(m_lastBarState, state, BAR_TOPICS_DEFAULT));
+	bool sharedReplaced = false;
+	if (SHAREDCHANGED && !m_pSharedState->write(state, m_barStamp.seq)) {
+		auto sharedState =
+		    makeUnique<SemmetySharedState>(SemmetySharedState::requiredSize(state) * 2);
+		if (sharedState->valid() && sharedState->write(state, m_barStamp.seq)) {
+			m_pSharedState->markReplaced();
+			m_pSharedState = std::move(sharedState);
+			sharedReplaced = true;
+		} else {
+			semmety_log(Ipc, Log::ERR, "Socket2 couldn't grow the shared state, errno: {}", errno);
+		}
+	}
+
+	// Payloads are only built for the kind, view, encoding and topic combinations that have
+	// clients, and are shared between them.
+	enum : uint64_t { PAYLOAD_FULL, PAYLOAD_DELTA, PAYLOAD_SNAPSHOT, PAYLOAD_CHANGED, PAYLOAD_SHM };
+	std::unordered_map<uint64_t, SP<std::string>> payloads;
+	std::unordered_map<uint64_t, std::optional<json>> deltas;
+
+	const auto encode = [&](uint64_t kind,
+	                        const SView& view,
+	                        eSemmetyBarEncoding encoding,
+	                        SemmetyBarTopics topics) {
+		auto& payload = payloads[kind << 40 | view.index << 16 | (uint64_t) encoding << 8 | topics];
+		if (payload) { return payload; }
+
+		const auto& next = view.next;
+		switch (kind) {
+		case PAYLOAD_FULL:
+			payload = encodeMessage(
+			    encoding,
+			    [&](std::string& out) { writeBarUpdateJson(out, next, m_barStamp, topics); },
+			    [&](std::string& out) { writeBarUpdateMsgpack(out, next, m_barStamp, topics); },
+			    &m_iBarMessageSize
+			);
+			break;
+		case PAYLOAD_DELTA: {
+			const auto& delta = deltas.at(view.index << 8 | topics);
+			// invalid UTF-8 is replaced, as in encodeJson()
+			payload = encodeMessage(
+			    encoding,
+			    [&](std::string& out) {
+				    out += delta->dump(-1, ' ', false, json::error_handler_t::replace);
+			    },
+			    [&](std::string& out) { json::to_msgpack(*delta, out); }
+			);
+			break;
+		}
+		case PAYLOAD_SNAPSHOT:
+			payload = encodeMessage(
+			    encoding,
+			    [&](std::string& out) { writeBarSnapshotJson(out, next, m_barStamp, topics); },
+			    [&](std::string& out) { writeBarSnapshotMsgpack(out, next, m_barStamp, topics); },
+			    &m_iBarMessageSize
+			);
+			break;
+		case PAYLOAD_CHANGED:
+			payload = encodeJson(
+			    encoding,
+			    {{"type", "changed"}, {"seq", m_barStamp.seq}, {"time", m_barStamp.time}}
+			);
+			break;
+		case PAYLOAD_SHM: payload = encodeJson(encoding, sharedStateJson()); break;
+		}
+
+		return payload;
+	};
+
+	const auto payloadFor = [&](const SClient& client, const SView& view) -> SP<std::string> {
+		switch (client.mode) {
+		case eSemmetyBarMode::Full:
+			// clients that picked their topics or monitor are only sent changes to them
+			if ((client.subscribed || !client.monitor.empty())
+			    && !barTopicsChanged(view.prev, view.next, client.topics)) {
+				return nullptr;
+			}
+
+			return encode(PAYLOAD_FULL, view, client.encoding, client.topics);
+		case eSemmetyBarMode::Diff: {
+			auto [delta, inserted] = deltas.try_emplace(view.index << 8 | client.topics);
+			if (inserted) {
+				delta->second = barDeltaJson(
+				    view.prev,
+				    view.next,
+				    m_barStamp,
+				    baseFor(view, client.topics),
+				    client.topics
+				);
+			}
+
+			// nothing to send when none of the client's topics changed
+			if (!delta->second) { return nullptr; }
+			return encode(PAYLOAD_DELTA, view, client.encoding, client.topics);
+		}
+		case eSemmetyBarMode::Shared:
+			if (!SHAREDCHANGED) { return nullptr; }
+			return encode(sharedReplaced ? PAYLOAD_SHM : PAYLOAD_CHANGED, view, client.encoding, 0);
+		}
+
+		return nullptr;
+	};
+
 	for (auto it = m_vClients.begin(); it != m_vClients.end();) {
-		// try to send the event immediately if the queue is empty
-		const auto QUEUESIZE = it->events.size();
-		if (QUEUESIZE > 0
-		    || write(it->fd.get(), sharedUpdateJson->c_str(), sharedUpdateJson->length()) < 0)
-		{
-			if (QUEUESIZE >= MAX_QUEUED_EVENTS) {
-				// too many events queued, remove the client
-				Log::logger->log(Log::ERR, "Socket2 fd {} overflowed event queue, removing", it->fd.get());
-				it = removeClientByFD(it->fd.get());
-				continue;
+		const bool SHARED = it->mode == eSemmetyBarMode::Shared;
+		const auto& view = viewFor(*it);
+
+		// A state gathered before the client subscribed to a topic or followed a monitor doesn't
+		// hold it. The client waits for the update its command requested, its snapshot with it.
+		const auto MISSING = static_cast<SemmetyBarTopics>(~view.next.gathered);
+		if (!SHARED && (it->topics & MISSING)) {
+			++it;
+			continue;
+		}
+
+		// A requested snapshot that covers all of the client's topics stands in for its update,
+		// otherwise it is sent after it. shm clients always get their notification, it may carry
+		// a new region.
+		const SemmetyBarTopics SNAPSHOT =
+		    (it->pendingSnapshot & MISSING) == 0 ? std::exchange(it->pendingSnapshot, 0) : 0;
+		const bool REPLACESUPDATE =
+		    !SHARED && SNAPSHOT != 0 && (SNAPSHOT & it->topics) == it->topics;
+
+		const auto snapshot = [&] { return encode(PAYLOAD_SNAPSHOT, view, it->encoding, SNAPSHOT); };
+		auto event = REPLACESUPDATE ? snapshot() : payloadFor(*it, view);
+		// full updates and deltas, a newer update or snapshot makes them stale
+		bool replaceable = !SHARED && !REPLACESUPDATE;
+
+		SP<Hyprutils::OS::CFileDescriptor> eventFD;
+		if (SHARED && event && sharedReplaced) {
+			eventFD = m_pSharedState->fd();
+		} else if (SHARED && event && !it->events.empty()) {
+			// the region is already updated, and a queued notification covers this one too
+			event = nullptr;
+			it->conflatedEvents += 1;
+		}
+
+		SP<std::string> reply;
+		if (SNAPSHOT != 0 && !REPLACESUPDATE) {
+			if (event) {
+				reply = snapshot();
+			} else {
+				event = snapshot();
+				replaceable = false;
 			}
+		}
 
-			// queue it to send later if failed
-			it->events.push_back(sharedUpdateJson);
+		if (!event) {
+			++it;
+			continue;
+		}
+
+		// Latest value wins. Every full-mode update is the complete state, so any unsent update is
+		// stale. Deltas can't be skipped, so a diff-mode client is only collapsed once its queue is
+		// full, onto a snapshot it can resync from. Snapshots and replies to queries are never
+		// dropped. shm clients are conflated above.
+		if (it->backpressure == eSemmetyBackpressure::Conflate && !SHARED) {
+			const bool CONFLATE = it->mode == eSemmetyBarMode::Full ? !it->events.empty()
+			                                                        : it->events.full();
+			if (CONFLATE) {
+				const auto QUEUED = it->events.size();
+				it->events.dropReplaceable();
+				it->conflatedEvents += QUEUED - it->events.size();
+				if (it->mode == eSemmetyBarMode::Diff) {
+					event = encode(PAYLOAD_SNAPSHOT, view, it->encoding, it->topics | SNAPSHOT);
+					replaceable = false;
+					reply.reset();
+				}
+			}
+		}
 
-			// poll for write if queue was empty
-			if (QUEUESIZE == 0) wl_event_source_fd_update(it->eventSource, WL_EVENT_WRITABLE);
+		if (!sendToClient(*it, event, eventFD, replaceable)
+		    || (reply && !sendToClient(*it, reply))) {
+			it = removeClientByFD(it->fd.get());
+			continue;
 		}
 
 		++it;
 	}
+
+	for (auto& [monitor, view]: views) {
+		for (size_t bit = 0; bit < view.topicSeqs.size(); bit++) {
+			if (barTopicsChanged(view.prev, view.next, 1 << bit)) {
+				view.topicSeqs[bit] = m_barStamp.seq;
+			}
+		}
+	}
+
+	// monitor names come from clients, only keep the ones some client still follows
+	std::erase_if(m_viewTopicSeqs, [&](const auto& entry) {
+		return !entry.first.empty() && std::ranges::none_of(m_vClients, [&](const auto& client) {
+			return client.monitor == entry.first;
+		});
+	});
+
+	m_lastBarState = std::move(state);
+	updateWantedTopics();
 }
@@ -1,5 +1,10 @@
 // copied from hyprland EventManager
 #pragma once
+#include <array>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <hyprland/src/defines.hpp>
@@ -7,39 +12,202 @@
 #include <hyprland/src/managers/EventManager.hpp>
 #include <hyprutils/os/FileDescriptor.hpp>
 
+#include "SemmetyBarState.hpp"
+#include "SemmetyEventQueue.hpp"
+#include "SemmetySharedState.hpp"
+#include "SemmetySpscQueue.hpp"
+
 struct SemmetyIPCEvent {
 	std::string event;
 	std::string data;
 };
 
+// Clients may write newline terminated commands to the socket:
+//   mode full         every update is the complete bar state (the default)
+//   mode diff         send one snapshot now, then only delta records (see barDeltaJson)
+//   mode shm          receive {"type": "shm", "size": N, "seq": N} with the fd of a shared memory
+//                     region holding the windows and workspaces (see SemmetySharedState), then
+//                     only {"type": "changed", "seq": N} when they changed. The shm message is
+//                     sent again with a new fd whenever the region is replaced.
+//   encoding json     newline delimited JSON messages (the default)
+//   encoding msgpack  MessagePack messages, each prefixed with its 4 byte little-endian length
+//   backpressure conflate    latest value wins for slow clients (the default): a full-mode
+//                            client only keeps the newest unsent update queued, a diff-mode
+//                            client whose queue fills up is resynced with a fresh snapshot.
+//                            Snapshots and command replies are never dropped
+//   backpressure disconnect  drop the client once its queue is full
+//   subscribe TOPIC...       only receive the listed topics (windows, workspaces, focus, frames),
+//                            starting with a snapshot of them. Updates are then only sent when
+//                            one of them changed. Clients that never subscribe get windows and
+//                            workspaces on every update. frames only holds the leaf frames of
+//                            the focused workspace, not the splits between them.
+//   monitor [NAME]           follow the windows and workspaces of monitor NAME instead of the
+//                            focused monitor, starting with a snapshot. Updates are then only
+//                            sent when that monitor's view changed. Without NAME, follow focus.
+//   snapshot [TOPIC...]      one-shot query, replied to with a snapshot of the listed topics or,
+//                            by default, the subscribed ones
+//   stats                    reply with {"type": "stats", ...}: the current seq and, per client,
+//                            the last seq queued for and completely written to it, its queue
+//                            depth and the bytes written to it, and per layout entry point
+//                            ("entryPoints") the call count, the p50, p99 and max latency and
+//                            the time spent in invariant checks, in nanoseconds
+//   stats reset              clear the entry point latencies
+//   allocs                   reply with {"type": "allocs", ...}: per layout entry point
+//                            ("entryPoints") and for the render and tick hooks ("hooks") the
+//                            call count, the heap allocations and bytes, the most allocations
+//                            in one call and how many calls allocated at all. Only counted in
+//                            builds with -Dalloc_stats=true, "enabled" says whether this one is
+//   allocs reset             clear the allocation counts
+//   perf                     reply with {"type": "perf", ...}: the cycles, instructions, cache
+//                            misses and branch misses per layout entry point ("entryPoints")
+//                            and for the render and tick hooks ("hooks"), counted when
+//                            plugin:semmety:perf_counters is set. "counters" lists the ones
+//                            that opened. When none did, "enabled" is false and "error" says why
+//   perf reset               clear the counter totals
+// Select the encoding before the mode, the diff snapshot is sent in the current encoding.
+//
+// Every message carries "seq" and "time". seq grows by one with each published update, time is
+// the CLOCK_MONOTONIC time in microseconds at which the compositor published it, so clients can
+// drop stale messages and measure delivery latency. A delta also carries "base", the seq of the
+// last update that changed any of its topics. A diff client that has not seen a message with a
+// seq of at least base has missed one and should resync with "snapshot".
+enum class eSemmetyBarMode {
+	Full,
+	Diff,
+	Shared,
+};
+
+enum class eSemmetyBarEncoding {
+	Json,
+	MsgPack,
+};
+
+enum class eSemmetyBackpressure {
+	Conflate,
+	Disconnect,
+};
+
+// What the compositor thread hands to the I/O thread.
+struct SemmetyBarUpdate {
+	SemmetyBarState state;
+	uint64_t time = 0; // CLOCK_MONOTONIC, in microseconds
+};
+
+// The socket, its clients and all serialization live on a dedicated I/O thread with its own event
+// loop. The compositor thread only gathers a SemmetyBarState and queues it with postBarUpdate().
+// Client commands that need fresh state ask the compositor thread to publish again.
 class SemmetyEventManager {
 public:
-	SemmetyEventManager();
+	// `publish` is called on the compositor thread when a client needs fresh state, it should gather
+	// the state and hand it to postBarUpdate() (see updateBar()).
+	explicit SemmetyEventManager(std::function<void()> publish);
 	~SemmetyEventManager();
 
-	void postBarUpdate(std::string updateJson);
+	// Compositor thread only.
+	void postBarUpdate(SemmetyBarState state);
+
+	// Union of the topics any client is subscribed to or has a pending snapshot for. The bar state
+	// only needs to contain these, and nothing needs to be published when it is 0.
+	SemmetyBarTopics wantedTopics() const { return m_wantedTopics.load(std::memory_order_relaxed); }
 
 private:
 	static int onServerEvent(int fd, uint32_t mask, void* data);
 	static int onClientEvent(int fd, uint32_t mask, void* data);
+	static int onWakeup(int fd, uint32_t mask, void* data);
+	static int onPublishRequest(int fd, uint32_t mask, void* data);
 
 	int onServerEvent(int fd, uint32_t mask);
 	int onClientEvent(int fd, uint32_t mask);
 
+	// I/O thread
+	void run();
+	void publishBarState(SemmetyBarUpdate update);
+	void requestPublish();
+	void updateWantedTopics();
+
 	struct SClient {
 		Hyprutils::OS::CFileDescriptor fd;
-		std::vector<SP<std::string>> events;
+		SemmetyEventQueue events;
 		wl_event_source* eventSource = nullptr;
+		eSemmetyBarMode mode = eSemmetyBarMode::Full;
+		eSemmetyBarEncoding encoding = eSemmetyBarEncoding::Json;
+		eSemmetyBackpressure backpressure = eSemmetyBackpressure::Conflate;
+		std::string readBuffer;
+		uint64_t conflatedEvents = 0;
+		uint64_t lastQueuedSeq = 0;
+		SemmetyBarTopics topics = BAR_TOPICS_DEFAULT;
+		bool subscribed = false;
+		// topics to send a snapshot of with the next update
+		SemmetyBarTopics pendingSnapshot = 0;
+		// monitor whose view the client follows, the focused one if empty
+		std::string monitor;
 	};
 
 	std::vector<SClient>::iterator findClientByFD(int fd);
 	std::vector<SClient>::iterator removeClientByFD(int fd);
 
+	bool readClientCommands(SClient& client);
+	bool handleClientCommand(SClient& client, std::string_view command);
+	std::optional<SemmetyBarTopics> parseTopics(const SClient& client, std::string_view list);
+	bool sendToClient(
+	    SClient& client,
+	    const SP<std::string>& event,
+	    SP<Hyprutils::OS::CFileDescriptor> fd = nullptr,
+	    bool replaceable = false
+	);
+	bool ensureSharedState();
+	SP<std::string> encodeJson(eSemmetyBarEncoding encoding, const json& message);
+	json sharedStateJson() const;
+	json statsJson() const;
+
+	template <typename JsonFn, typename MsgpackFn>
+	SP<std::string> encodeMessage(
+	    eSemmetyBarEncoding encoding,
+	    JsonFn&& writeJson,
+	    MsgpackFn&& writeMsgpack,
+	    size_t* sizeHint = nullptr
+	);
+
 private:
 	Hyprutils::OS::CFileDescriptor m_iSocketFD;
 	wl_event_source* m_pEventSource = nullptr;
 
+	// Owned by the I/O thread, as is everything below that is not atomic.
+	wl_event_loop* m_pEventLoop = nullptr;
+	std::thread m_thread;
+	std::atomic<bool> m_bStopping = false;
+
+	// Signals the I/O thread that updates were queued or that it should stop.
+	Hyprutils::OS::CFileDescriptor m_iWakeupFD;
+	wl_event_source* m_pWakeupSource = nullptr;
+	// Signals the compositor thread that a client wants fresh state.
+	Hyprutils::OS::CFileDescriptor m_iPublishRequestFD;
+	wl_event_source* m_pPublishRequestSource = nullptr;
+	std::function<void()> m_publish;
+
+	// Each update is a complete state, so the I/O thread only publishes the newest one it finds.
+	// When the queue is full the update is dropped and the compositor asked to publish again once
+	// there is room.
+	SemmetySpscQueue<SemmetyBarUpdate, 16> m_updates;
+	std::atomic<bool> m_bUpdatesDropped = false;
+	std::atomic<uint64_t> m_iDroppedUpdates = 0;
+
+	std::atomic<SemmetyBarTopics> m_wantedTopics = 0;
+
 	std::vector<SClient> m_vClients;
+
+	SemmetyBarState m_lastBarState;
+	SemmetyBarStamp m_barStamp;
+	// seq of the last update that changed each topic, indexed by topic bit, per view (monitor name
+	// or empty for the focused view). Views no client follows are dropped after each update.
+	std::unordered_map<std::string, std::array<uint64_t, 8>> m_viewTopicSeqs;
+
+	// Size of the last bar document encoded, reserved up front for the next one so it is usually
+	// written without growing.
+	size_t m_iBarMessageSize = 0;
+
+	// Created when the first client switches to shm mode.
+	UP<SemmetySharedState> m_pSharedState;
 };
 
 inline UP<SemmetyEventManager> g_SemmetyEventManager;
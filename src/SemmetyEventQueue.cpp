@@ -0,0 +1,130 @@
+#include "SemmetyEventQueue.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "SemmetySpans.hpp"
+
+size_t SemmetyEventQueue::queuedBytes() const {
+	size_t bytes = 0;
+	for (size_t i = 0; i < m_size; i++) { bytes += at(i)->length(); }
+
+	return bytes - m_headOffset;
+}
+
+bool SemmetyEventQueue::push(
+    SP<std::string> event,
+    uint64_t seq,
+    SP<Hyprutils::OS::CFileDescriptor> fd,
+    bool replaceable
+) {
+	if (full()) { return false; }
+
+	const auto slot = (m_head + m_size) % CAPACITY;
+	m_events[slot] = std::move(event);
+	m_fds[slot] = std::move(fd);
+	m_seqs[slot] = seq;
+	m_replaceable[slot] = replaceable;
+	m_size += 1;
+	return true;
+}
+
+void SemmetyEventQueue::dropReplaceable() {
+	size_t kept = m_headOffset > 0 ? 1 : 0;
+	for (size_t i = kept; i < m_size; i++) {
+		const auto from = (m_head + i) % CAPACITY;
+		if (m_replaceable[from]) {
+			m_events[from].reset();
+			m_fds[from].reset();
+			continue;
+		}
+
+		// move the message down over the dropped ones
+		const auto to = (m_head + kept) % CAPACITY;
+		if (to != from) {
+			m_events[to] = std::move(m_events[from]);
+			m_fds[to] = std::move(m_fds[from]);
+			m_seqs[to] = m_seqs[from];
+			m_replaceable[to] = false;
+		}
+
+		kept += 1;
+	}
+
+	m_size = kept;
+}
+
+void SemmetyEventQueue::pop() {
+	m_lastWrittenSeq = m_seqs[m_head];
+	at(0).reset();
+	fdAt(0).reset();
+	m_head = (m_head + 1) % CAPACITY;
+	m_size -= 1;
+	m_headOffset = 0;
+}
+
+bool SemmetyEventQueue::flush(int fd) {
+	const SemmetySpan span("flush");
+
+	while (!empty()) {
+		std::array<iovec, CAPACITY> iov;
+		size_t count = 0;
+		size_t total = 0;
+		// a batch ends before the next message carrying an fd, so that fd arrives with its message
+		while (count < std::min<size_t>(m_size, IOV_MAX) && (count == 0 || !fdAt(count))) {
+			const auto& event = at(count);
+			const auto offset = count == 0 ? m_headOffset : 0;
+
+			iov[count] = {.iov_base = event->data() + offset, .iov_len = event->length() - offset};
+			total += iov[count].iov_len;
+			count += 1;
+		}
+
+		msghdr message = {.msg_iov = iov.data(), .msg_iovlen = count};
+
+		// the fd goes out with the first byte written, so only attach it once
+		alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+		if (fdAt(0) && m_headOffset == 0) {
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+
+			auto* cmsg = CMSG_FIRSTHDR(&message);
+			cmsg->cmsg_level = SOL_SOCKET;
+			cmsg->cmsg_type = SCM_RIGHTS;
+			cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+
+			const int passed = fdAt(0)->get();
+			std::memcpy(CMSG_DATA(cmsg), &passed, sizeof(int));
+		}
+
+		const auto written = sendmsg(fd, &message, MSG_NOSIGNAL);
+		if (written < 0) {
+			if (errno == EINTR) { continue; }
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+
+		m_bytesWritten += written;
+
+		// drop every fully written message, and remember how far into the next one we got
+		auto remaining = static_cast<size_t>(written);
+		while (remaining > 0) {
+			const auto left = at(0)->length() - m_headOffset;
+			if (remaining < left) {
+				m_headOffset += remaining;
+				break;
+			}
+
+			remaining -= left;
+			pop();
+		}
+
+		// a short write means the socket buffer is full
+		if (static_cast<size_t>(written) < total) { break; }
+	}
+
+	return true;
+}
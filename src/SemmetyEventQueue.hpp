@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/os/FileDescriptor.hpp>
+
+// Fixed capacity ring of outgoing messages for one socket client. Messages are shared between
+// clients, so the queue only tracks how many bytes of the front message were already written,
+// which keeps the stream framing intact across partial writes.
+class SemmetyEventQueue {
+public:
+	static constexpr size_t CAPACITY = 64;
+
+	bool empty() const { return m_size == 0; }
+	bool full() const { return m_size == CAPACITY; }
+	size_t size() const { return m_size; }
+	size_t queuedBytes() const;
+
+	// Returns false if the queue is full. `seq` is the bar update the message belongs to. If `fd` is
+	// set it is passed to the peer with SCM_RIGHTS along with the first byte of the message. A
+	// `replaceable` message is a bar update that a newer one makes stale, see dropReplaceable().
+	bool push(
+	    SP<std::string> event,
+	    uint64_t seq,
+	    SP<Hyprutils::OS::CFileDescriptor> fd = nullptr,
+	    bool replaceable = false
+	);
+
+	// seq of the last message that was completely written.
+	uint64_t lastWrittenSeq() const { return m_lastWrittenSeq; }
+	uint64_t bytesWritten() const { return m_bytesWritten; }
+
+	// Drops every replaceable message that has not started being written, keeping the others in
+	// order. A partially written message is kept so the stream stays well formed.
+	void dropReplaceable();
+
+	// Writes as much of the queue as the socket accepts, batching messages with sendmsg. Returns
+	// false on a write error other than the socket being full.
+	bool flush(int fd);
+
+private:
+	std::array<SP<std::string>, CAPACITY> m_events;
+	std::array<SP<Hyprutils::OS::CFileDescriptor>, CAPACITY> m_fds;
+	std::array<uint64_t, CAPACITY> m_seqs {};
+	std::array<bool, CAPACITY> m_replaceable {};
+	uint64_t m_lastWrittenSeq = 0;
+	uint64_t m_bytesWritten = 0;
+	size_t m_head = 0;
+	size_t m_size = 0;
+	size_t m_headOffset = 0;
+
+	SP<std::string>& at(size_t index) { return m_events[(m_head + index) % CAPACITY]; }
+	const SP<std::string>& at(size_t index) const { return m_events[(m_head + index) % CAPACITY]; }
+	SP<Hyprutils::OS::CFileDescriptor>& fdAt(size_t index) {
+		return m_fds[(m_head + index) % CAPACITY];
+	}
+	void pop();
+};
@@ -0,0 +1,166 @@
+#include "SemmetyFlightRecorder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <vector>
+
+//
+// SemmetyFlightRecorder
+//
+
+template <typename Fn>
+void SemmetyFlightRecorder::update(uint64_t index, Fn&& write) {
+	if (m_next.load(std::memory_order_relaxed) - index > CAPACITY) { return; }
+
+	auto& record = m_records[index % CAPACITY];
+	if (record.seq.load(std::memory_order_relaxed) != index * 2 + 2) { return; }
+
+	record.seq.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	write(record);
+	record.seq.store(index * 2 + 2, std::memory_order_release);
+}
+
+uint64_t SemmetyFlightRecorder::open(std::string_view name, uint64_t start, uint32_t depth) {
+	const auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+	auto& record = m_records[index % CAPACITY];
+
+	record.seq.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	record.start = start;
+	record.durationNs = 0;
+	record.workspace = 0;
+	record.frame = 0;
+	record.window = 0;
+	record.depth = std::min<uint32_t>(depth, UINT8_MAX);
+	record.state = SemmetyFlightState::Open;
+
+	const auto length = std::min(name.size(), sizeof(record.name) - 1);
+	std::memcpy(record.name, name.data(), length);
+	record.name[length] = '\0';
+
+	record.seq.store(index * 2 + 2, std::memory_order_release);
+	return index;
+}
+
+void SemmetyFlightRecorder::note(
+    uint64_t index,
+    int64_t workspace,
+    uintptr_t frame,
+    uintptr_t window
+) {
+	update(index, [&](SRecord& record) {
+		if (workspace != 0) { record.workspace = workspace; }
+		if (frame != 0) { record.frame = frame; }
+		if (window != 0) { record.window = window; }
+	});
+}
+
+void SemmetyFlightRecorder::close(uint64_t index, uint64_t durationNs, SemmetyFlightState state) {
+	update(index, [&](SRecord& record) {
+		record.durationNs = durationNs;
+		record.state = state;
+	});
+}
+
+std::string SemmetyFlightRecorder::decode() const {
+	struct SCopy {
+		uint64_t start;
+		uint64_t durationNs;
+		int64_t workspace;
+		uintptr_t frame;
+		uintptr_t window;
+		uint8_t depth;
+		SemmetyFlightState state;
+		char name[sizeof(SRecord::name)];
+	};
+
+	const auto next = m_next.load(std::memory_order_acquire);
+	const auto first = next > CAPACITY ? next - CAPACITY : 0;
+
+	std::vector<SCopy> copies;
+	copies.reserve(next - first);
+
+	for (auto index = first; index < next; index++) {
+		const auto& record = m_records[index % CAPACITY];
+
+		const auto seq = record.seq.load(std::memory_order_acquire);
+		if (seq != index * 2 + 2) { continue; }
+
+		SCopy copy {
+		    .start = record.start,
+		    .durationNs = record.durationNs,
+		    .workspace = record.workspace,
+		    .frame = record.frame,
+		    .window = record.window,
+		    .depth = record.depth,
+		    .state = record.state,
+		};
+		std::memcpy(copy.name, record.name, sizeof(copy.name));
+		copy.name[sizeof(copy.name) - 1] = '\0';
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (record.seq.load(std::memory_order_relaxed) != seq) { continue; }
+
+		copies.push_back(copy);
+	}
+
+	if (copies.empty()) { return "no entry points recorded\n"; }
+
+	const auto newest = copies.back().start;
+	std::string out;
+
+	for (const auto& copy: copies) {
+		out += std::format(
+		    "{:>12.3f}ms {}{}",
+		    ((double) copy.start - (double) newest) / 1e6,
+		    std::string(copy.depth * 2, ' '),
+		    copy.name
+		);
+
+		if (copy.workspace != 0) { out += std::format(" workspace {}", copy.workspace); }
+		if (copy.frame != 0) { out += std::format(" frame {:x}", copy.frame); }
+		if (copy.window != 0) { out += std::format(" window {:x}", copy.window); }
+
+		switch (copy.state) {
+		case SemmetyFlightState::Open: out += " OPEN\n"; break;
+		case SemmetyFlightState::Done: out += std::format(" {}ns\n", copy.durationNs); break;
+		case SemmetyFlightState::Failed: out += std::format(" {}ns failed\n", copy.durationNs); break;
+		case SemmetyFlightState::Threw: out += std::format(" {}ns threw\n", copy.durationNs); break;
+		}
+	}
+
+	return out;
+}
+
+//
+// SemmetyFlightEntry
+//
+
+SemmetyFlightEntry::SemmetyFlightEntry(std::string_view name):
+    m_start(semmetyMonotonicNs()), m_outer(t_open) {
+	m_index = g_semmetyFlight.open(name, m_start, t_depth++);
+	t_open = m_index;
+}
+
+SemmetyFlightEntry::~SemmetyFlightEntry() {
+	if (!m_finished) {
+		g_semmetyFlight.close(m_index, semmetyMonotonicNs() - m_start, SemmetyFlightState::Threw);
+	}
+
+	t_open = m_outer;
+	t_depth -= 1;
+}
+
+void SemmetyFlightEntry::finish(bool failed) {
+	const auto state = failed ? SemmetyFlightState::Failed : SemmetyFlightState::Done;
+	g_semmetyFlight.close(m_index, semmetyMonotonicNs() - m_start, state);
+	m_finished = true;
+}
+
+void SemmetyFlightEntry::note(int64_t workspace, uintptr_t frame, uintptr_t window) {
+	if (t_open < 0) { return; }
+
+	g_semmetyFlight.note(t_open, workspace, frame, window);
+}
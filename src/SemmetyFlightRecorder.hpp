@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "SemmetyClock.hpp"
+
+enum class SemmetyFlightState : uint8_t {
+	// still running, or the process died in it
+	Open,
+	Done,
+	// returned an error message
+	Failed,
+	// left by an exception, usually semmety_critical_error()
+	Threw,
+};
+
+// The last entry points run, always recorded and only decoded when something asks for them: a
+// critical error or semmety:dumpflight. Each entry point is one fixed-size record in a ring that
+// never allocates, written without locks. A reader on another thread skips records that are being
+// written.
+class SemmetyFlightRecorder {
+public:
+	static constexpr size_t CAPACITY = 1024;
+
+	uint64_t open(std::string_view name, uint64_t start, uint32_t depth);
+	// Sets what record `index` works on, a zero leaves the field as it is.
+	void note(uint64_t index, int64_t workspace, uintptr_t frame, uintptr_t window);
+	void close(uint64_t index, uint64_t durationNs, SemmetyFlightState state);
+	// One line per record, oldest first, with times relative to the newest record.
+	std::string decode() const;
+
+private:
+	struct SRecord {
+		// 2 * index + 2 once record `index` is consistent, odd while it is being written
+		std::atomic<uint64_t> seq = 0;
+		uint64_t start = 0;
+		uint64_t durationNs = 0;
+		int64_t workspace = 0;
+		uintptr_t frame = 0;
+		uintptr_t window = 0;
+		uint8_t depth = 0;
+		SemmetyFlightState state = SemmetyFlightState::Open;
+		char name[30] = {};
+	};
+
+	// Runs `write` on record `index` under its seqlock, unless the ring has moved past it.
+	template <typename Fn>
+	void update(uint64_t index, Fn&& write);
+
+	std::array<SRecord, CAPACITY> m_records;
+	std::atomic<uint64_t> m_next = 0;
+};
+
+inline SemmetyFlightRecorder g_semmetyFlight;
+
+// Records the scope as an entry point in g_semmetyFlight. note() describes the innermost entry
+// point open on the calling thread.
+class SemmetyFlightEntry {
+public:
+	explicit SemmetyFlightEntry(std::string_view name);
+	// Closes the record as Threw if finish() wasn't called.
+	~SemmetyFlightEntry();
+
+	void finish(bool failed);
+	static void note(int64_t workspace, uintptr_t frame, uintptr_t window);
+
+	SemmetyFlightEntry(const SemmetyFlightEntry&) = delete;
+	SemmetyFlightEntry& operator=(const SemmetyFlightEntry&) = delete;
+
+private:
+	uint64_t m_index;
+	uint64_t m_start;
+	int64_t m_outer;
+	bool m_finished = false;
+
+	// index of the innermost open entry on this thread, -1 outside of any
+	inline static thread_local int64_t t_open = -1;
+	inline static thread_local uint32_t t_depth = 0;
+};
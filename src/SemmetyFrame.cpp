@@ -1,23 +1,16 @@
 #include "SemmetyFrame.hpp"
+#include <algorithm>
+#include <format>
 #include <sstream>
 #include <utility>
 
-#include <hyprland/src/config/ConfigManager.hpp>
-#include <hyprland/src/config/ConfigValue.hpp>
-#include <hyprland/src/config/shared/animation/AnimationTree.hpp>
-#include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
-#include <hyprland/src/desktop/DesktopTypes.hpp>
-#include <hyprland/src/desktop/view/Window.hpp>
-#include <hyprland/src/layout/target/Target.hpp>
-#include <hyprland/src/render/Renderer.hpp>
-#include <hyprland/src/xwayland/XSurface.hpp>
 #include <hyprutils/math/Box.hpp>
 #include <hyprutils/memory/SharedPtr.hpp>
 
+#include "SemmetyError.hpp"
 #include "SemmetyFrameUtils.hpp"
-#include "log.hpp"
-#include <hyprland/src/config/shared/complex/ComplexDataTypes.hpp>
-#include "utils.hpp"
+#include "SemmetySpans.hpp"
+#include "SemmetyWorkspace.hpp"
 
 //
 // SemmetyFrame
@@ -132,10 +125,12 @@ SemmetySplitFrame::SemmetySplitFrame(
 }
 
 void SemmetySplitFrame::applyRecursive(
-    SemmetyWorkspaceWrapper& workspace,
+    SemmetyWorkspace& workspace,
     std::optional<CBox> newGeometry,
     std::optional<bool> force
 ) {
+	const SemmetySpan span("applyRecursive");
+
 	if (newGeometry.has_value()) { geometry = newGeometry.value(); }
 
 	auto childGeometries = getChildGeometries();
@@ -246,7 +241,7 @@ const std::pair<SP<SemmetyFrame>, SP<SemmetyFrame>>& SemmetySplitFrame::getChild
 	return children;
 }
 
-std::string SemmetySplitFrame::print(SemmetyWorkspaceWrapper& workspace, int indentLevel) const {
+std::string SemmetySplitFrame::print(SemmetyWorkspace& workspace, int indentLevel) const {
 	std::string indent(indentLevel * 2, ' ');
 	std::string result;
 	std::string geometryString = getGeometryString(geometry);
@@ -265,42 +260,19 @@ bool SemmetySplitFrame::isSplit() const { return true; }
 // SemmetyLeafFrame
 //
 
-SP<SemmetyLeafFrame> SemmetyLeafFrame::create(PHLWINDOWREF window, std::optional<bool> isActive) {
-	auto ptr = makeShared<SemmetyLeafFrame>(window, isActive);
+SP<SemmetyLeafFrame> SemmetyLeafFrame::create(SemmetyWindowRef window) {
+	auto ptr = makeShared<SemmetyLeafFrame>(window);
 	ptr->self = ptr;
 	return ptr;
 }
 
-SemmetyLeafFrame::SemmetyLeafFrame(PHLWINDOWREF window, std::optional<bool> isActive):
-    window(window) {
-	// In Hyprland 0.55 gradient config values are read via CConfigValue<Config::IComplexConfigValue>,
-	// whose ptr() already returns the (CGradientValueData) data. The old CUSTOMTYPE + ->getData()
-	// idiom returns a bad pointer and crashes.
-	static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
-	static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-
-	g_pAnimationManager->createAnimation(
-	    0.f,
-	    this->m_fBorderFadeAnimationProgress,
-	    Config::animationTree()->getAnimationPropertyConfig("border"),
-	    AVARDAMAGE_ENTIRE
-	);
-
-	Config::CGradientValueData* color;
-	if (isActive.value_or(false)) {
-		color = (Config::CGradientValueData*) PACTIVECOL.ptr();
-	} else {
-		color = (Config::CGradientValueData*) PINACTIVECOL.ptr();
-	}
-
-	m_cRealBorderColor = *color;
-}
+SemmetyLeafFrame::SemmetyLeafFrame(SemmetyWindowRef window): window(window) {}
 
 bool SemmetyLeafFrame::isEmpty() const { return window == nullptr; }
 
-PHLWINDOWREF SemmetyLeafFrame::getWindow() { return window; }
+SemmetyWindowRef SemmetyLeafFrame::getWindow() const { return window; }
 
-void SemmetyLeafFrame::setWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF win) {
+void SemmetyLeafFrame::setWindow(SemmetyWorkspace& workspace, SemmetyWindowRef win) {
 	if (window) {
 		// The caller must handle the case where there is an existing window
 		semmety_critical_error("setWindow called on non-empty frame");
@@ -309,8 +281,8 @@ void SemmetyLeafFrame::setWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWRE
 	_setWindow(workspace, win, true);
 }
 
-PHLWINDOWREF
-SemmetyLeafFrame::replaceWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF win) {
+SemmetyWindowRef
+SemmetyLeafFrame::replaceWindow(SemmetyWorkspace& workspace, SemmetyWindowRef win) {
 	// replacing a window with itself is a no-op returning null
 	if (win == window) { return {}; }
 
@@ -320,14 +292,14 @@ SemmetyLeafFrame::replaceWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF
 }
 
 void SemmetyLeafFrame::swapContents(
-    SemmetyWorkspaceWrapper& workspace,
+    SemmetyWorkspace& workspace,
     SP<SemmetyLeafFrame> other
 ) {
 	// update the Z order of the windows so that they appear over other windows during the swap
 	// animation
-	if (other->window) { g_pCompositor->changeWindowZOrder(other->window.lock(), true); }
+	if (other->window) { workspace.raiseWindow(other->window); }
 
-	if (window) { g_pCompositor->changeWindowZOrder(window.lock(), true); }
+	if (window) { workspace.raiseWindow(window); }
 
 	const auto tmp = window;
 	_setWindow(workspace, other->window, false);
@@ -335,8 +307,8 @@ void SemmetyLeafFrame::swapContents(
 }
 
 void SemmetyLeafFrame::_setWindow(
-    SemmetyWorkspaceWrapper& workspace,
-    PHLWINDOWREF win,
+    SemmetyWorkspace& workspace,
+    SemmetyWindowRef win,
     bool force
 ) {
 	window = win;
@@ -348,7 +320,7 @@ bool SemmetyLeafFrame::isSameOrDescendant(const SP<SemmetyFrame>& target) const
 	return self == target;
 }
 
-std::string SemmetyLeafFrame::print(SemmetyWorkspaceWrapper& workspace, int indentLevel) const {
+std::string SemmetyLeafFrame::print(SemmetyWorkspace& workspace, int indentLevel) const {
 	std::string indent(indentLevel * 2, ' ');
 	std::string result;
 	std::string geometryString = getGeometryString(geometry);
@@ -360,8 +332,8 @@ std::string SemmetyLeafFrame::print(SemmetyWorkspaceWrapper& workspace, int inde
 	//     window ? std::to_string(reinterpret_cast<uintptr_t>(window.lock().get())) : "";
 
 	if (window) {
-		result += indent + "SemmetyFrame (WindowId: " + std::format("{:x}", (uintptr_t) window.get())
-		        + ")" + focusIndicator + geometryString + "\n";
+		result += indent + "SemmetyFrame (WindowId: " + std::format("{:x}", window->id()) + ")"
+		        + focusIndicator + geometryString + "\n";
 	} else {
 		result += indent + "SemmetyFrame (Empty)" + focusIndicator + geometryString + "\n";
 	}
@@ -378,132 +350,12 @@ std::vector<SP<SemmetyLeafFrame>> SemmetyLeafFrame::getLeafFrames() const {
 	return {l};
 }
 
-CBox SemmetyLeafFrame::getStandardWindowArea(
-    CBox area,
-    SBoxExtents extents,
-    PHLWORKSPACE workspace
-) const {
-	static const auto p_gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, Config::CCssGapData>("general:gaps_in");
-
-	auto workspace_rule = Config::workspaceRuleMgr()->getWorkspaceRuleFor(workspace);
-	Config::CCssGapData gaps_in = *p_gaps_in;
-	if (workspace_rule && workspace_rule->m_gapsIn) { gaps_in = *workspace_rule->m_gapsIn; }
-
-	SBoxExtents inner_gap_extents;
-	inner_gap_extents.topLeft = Vector2D((int) -gaps_in.m_left, (int) -gaps_in.m_top);
-	inner_gap_extents.bottomRight = Vector2D((int) -gaps_in.m_right, (int) -gaps_in.m_bottom);
-
-	SBoxExtents combined_outer_extents;
-	combined_outer_extents.topLeft = -this->gap_topleft_offset;
-	combined_outer_extents.bottomRight = -this->gap_bottomright_offset;
-
-	// auto area = this->geometry;
-	area.addExtents(inner_gap_extents);
-	area.addExtents(combined_outer_extents);
-	area.addExtents(extents);
-
-	area.round();
-	return area;
-}
-
 void SemmetyLeafFrame::applyRecursive(
-    SemmetyWorkspaceWrapper& workspace,
+    SemmetyWorkspace& workspace,
     std::optional<CBox> newGeometry,
-    std::optional<bool> force
+    std::optional<bool>
 ) {
 	if (newGeometry.has_value()) { geometry = newGeometry.value(); }
 
-	if (!valid(window) || !window->m_isMapped) {
-		semmety_log(
-		    Log::ERR,
-		    "node {:x} is an unmapped window ({:x}), cannot apply node data, removing from tiled "
-		    "layout",
-		    (uintptr_t) this,
-		    (uintptr_t) window.get()
-		);
-		// Handle error notification or removal logic here
-		return;
-	}
-
-	if (window->isHidden()) { window->setHidden(false); }
-
-	window->updateWindowData();
-
-	if (window->isFullscreen()) {
-		const auto& monitor = window->m_monitor;
-
-		*window->m_realPosition = monitor->m_position;
-		*window->m_realSize = monitor->m_size;
-	} else {
-		geometry.round();
-
-		// Position through the window's layout target instead of writing m_realPosition/m_realSize
-		// directly. This keeps Hyprland's m_box consistent (its post-map recalc re-applies it, which
-		// previously clobbered our geometry and broke the open animation) and lets the engine drive
-		// the configured window-open animation (e.g. popin). We pass our exact window rect as
-		// visualBox so updatePos() uses it as-is rather than re-applying its own gap model, which
-		// preserves semmety's gap layout. logicalBox is the node box (the logical/tiled size).
-		// updatePos() adds the window's reserved area itself, so compute visualBox without it.
-		auto visualBox =
-		    this->getStandardWindowArea(this->geometry, SBoxExtents {}, workspace.workspace.lock());
-
-		if (auto target = window->layoutTarget()) {
-			target->setPositionGlobal(
-			    Layout::STargetBox {.logicalBox = this->geometry, .visualBox = visualBox}
-			);
-		}
-	}
-
-	// NOTE: we no longer warp m_realPosition/m_realSize here. Positioning now goes through the
-	// layout target (above), so Hyprland animates moves/resizes and plays the window-open animation.
-
-	window->updateWindowDecos();
-}
-
-// from void CCompositor::updateWindowAnimatedDecorationValues(PHLWINDOW pWindow) {
-void SemmetyLeafFrame::setBorderColor(Config::CGradientValueData grad) {
-	if (grad == m_cRealBorderColor) { return; }
-
-	m_cRealBorderColorPrevious = m_cRealBorderColor;
-	m_cRealBorderColor = grad;
-	m_fBorderFadeAnimationProgress->setValueAndWarp(0.f);
-	*m_fBorderFadeAnimationProgress = 1.f;
-}
-
-// from CHyprBorderDecoration::draw
-CBox SemmetyLeafFrame::getEmptyFrameBox(const CMonitor& monitor) {
-	static auto PBORDERSIZE = CConfigValue<Hyprlang::INT>("general:border_size");
-
-	const auto borderSize = static_cast<int>(-*PBORDERSIZE);
-	const auto borderOffset = Vector2D(borderSize, borderSize);
-	const auto borderExtent = SBoxExtents {borderOffset, borderOffset};
-
-	const auto workspace = monitor.m_activeWorkspace;
-	// do we need to worry about m_vRenderOffset being animated if we are getting the frame box for
-	// damage?
-	// PWINDOWWORKSPACE->m_vRenderOffset->isBeingAnimated()
-	const auto workspaceOffset = workspace ? workspace->m_renderOffset->value() : Vector2D();
-
-	auto frameBox = this->getStandardWindowArea(this->geometry, borderExtent, workspace);
-
-	return frameBox.translate(-monitor.m_position + workspaceOffset).scale(monitor.m_scale).round();
-}
-
-void SemmetyLeafFrame::damageEmptyFrameBox(const CMonitor& monitor) {
-	static auto PROUNDING = CConfigValue<Hyprlang::INT>("decoration:rounding");
-
-	const auto rounding = static_cast<float>(*PROUNDING);
-	const auto roundingSize = rounding - M_SQRT1_2 * rounding + 2;
-
-	const auto frameBox = this->getEmptyFrameBox(monitor);
-
-	CBox surfaceBoxShrunkRounding = frameBox;
-	surfaceBoxShrunkRounding.expand(-roundingSize);
-
-	CRegion borderRegion(frameBox);
-	borderRegion.subtract(surfaceBoxShrunkRounding);
-
-	// TODO: try to damage less
-	// g_pHyprRenderer->damageRegion(borderRegion);
-	g_pHyprRenderer->damageRegion(this->geometry);
+	if (window) { workspace.placeWindow(*this); }
 }
@@ -2,14 +2,14 @@
 
 #include <functional>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
-#include <hyprland/src/config/shared/complex/ComplexDataTypes.hpp>
-#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/helpers/memory/Memory.hpp>
 #include <hyprutils/math/Box.hpp>
 
-#include "src/helpers/AnimatedVariable.hpp"
+#include "SemmetyWindow.hpp"
 
 using namespace Hyprutils::Math;
 
@@ -20,7 +20,7 @@ enum class SemmetySplitDirection {
 
 class SemmetySplitFrame;
 class SemmetyLeafFrame;
-class SemmetyWorkspaceWrapper;
+class SemmetyWorkspace;
 
 class SemmetyFrame {
 public:
@@ -44,17 +44,17 @@ public:
 	virtual bool isLeaf() const = 0;
 	virtual bool isSplit() const = 0;
 	virtual void applyRecursive(
-	    SemmetyWorkspaceWrapper& workspace,
+	    SemmetyWorkspace& workspace,
 	    std::optional<CBox> newGeometry,
 	    std::optional<bool> force
 	) = 0;
 	virtual std::vector<SP<SemmetyLeafFrame>> getLeafFrames() const = 0;
-	virtual std::string print(SemmetyWorkspaceWrapper& workspace, int indentLevel = 0) const = 0;
+	virtual std::string print(SemmetyWorkspace& workspace, int indentLevel = 0) const = 0;
 
 protected:
 	std::vector<int> framePath; // Path from root: [0,1,0] means left->right->left
 
-	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspaceWrapper&);
+	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspace&);
 	friend void updateFramePathsRecursive(SP<SemmetyFrame>, const std::vector<int>&);
 };
 
@@ -76,13 +76,13 @@ public:
 	bool isLeaf() const override;
 	bool isSplit() const override;
 	void applyRecursive(
-	    SemmetyWorkspaceWrapper& workspace,
+	    SemmetyWorkspace& workspace,
 	    std::optional<CBox> newGeometry,
 	    std::optional<bool> force
 	) override;
 	std::vector<SP<SemmetyLeafFrame>> getLeafFrames() const override;
 	std::optional<size_t> pathLengthToDescendant(const SP<SemmetyFrame>& target) const;
-	std::string print(SemmetyWorkspaceWrapper& workspace, int indentLevel = 0) const override;
+	std::string print(SemmetyWorkspace& workspace, int indentLevel = 0) const override;
 
 private:
 	std::pair<SP<SemmetyFrame>, SP<SemmetyFrame>> children;
@@ -90,42 +90,36 @@ private:
 	SemmetySplitFrame(SP<SemmetyFrame> firstChild, SP<SemmetyFrame> secondChild, CBox _geometry);
 	template <typename U, typename... Args>
 	friend Hyprutils::Memory::CSharedPointer<U> Hyprutils::Memory::makeShared(Args&&...);
-	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspaceWrapper&);
+	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspace&);
 };
 
 class SemmetyLeafFrame: public SemmetyFrame {
 public:
-	static SP<SemmetyLeafFrame>
-	create(PHLWINDOWREF window, std::optional<bool> isActive = std::nullopt);
-	Config::CGradientValueData m_cRealBorderColor = {0};
-	Config::CGradientValueData m_cRealBorderColorPrevious = {0};
-	PHLANIMVAR<float> m_fBorderFadeAnimationProgress;
+	static SP<SemmetyLeafFrame> create(SemmetyWindowRef window = {});
 
 	bool isEmpty() const;
-	PHLWINDOWREF getWindow();
-	void setBorderColor(Config::CGradientValueData grad);
-	void setWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF win);
-	PHLWINDOWREF replaceWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF win);
-	CBox getStandardWindowArea(CBox area, SBoxExtents extents, PHLWORKSPACE workspace) const;
-	void damageEmptyFrameBox(const CMonitor& monitor);
-	CBox getEmptyFrameBox(const CMonitor& monitor);
-	void swapContents(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame> leafFrame);
+	SemmetyWindowRef getWindow() const;
+	void setWindow(SemmetyWorkspace& workspace, SemmetyWindowRef win);
+	SemmetyWindowRef replaceWindow(SemmetyWorkspace& workspace, SemmetyWindowRef win);
+	void swapContents(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> leafFrame);
 
 	bool isSameOrDescendant(const SP<SemmetyFrame>& target) const override;
 	bool isLeaf() const override;
 	bool isSplit() const override;
 	void applyRecursive(
-	    SemmetyWorkspaceWrapper& workspace,
+	    SemmetyWorkspace& workspace,
 	    std::optional<CBox> newGeometry = std::nullopt,
 	    std::optional<bool> force = std::nullopt
 	) override;
 	std::vector<SP<SemmetyLeafFrame>> getLeafFrames() const override;
-	std::string print(SemmetyWorkspaceWrapper& workspace, int indentLevel = 0) const override;
+	std::string print(SemmetyWorkspace& workspace, int indentLevel = 0) const override;
+
+protected:
+	explicit SemmetyLeafFrame(SemmetyWindowRef window);
 
 private:
-	PHLWINDOWREF window;
-	SemmetyLeafFrame(PHLWINDOWREF window, std::optional<bool> isActive = std::nullopt);
-	void _setWindow(SemmetyWorkspaceWrapper& workspace, PHLWINDOWREF win, bool force);
+	SemmetyWindowRef window;
+	void _setWindow(SemmetyWorkspace& workspace, SemmetyWindowRef win, bool force);
 
 	template <typename U, typename... Args>
 	friend Hyprutils::Memory::CSharedPointer<U> Hyprutils::Memory::makeShared(Args&&...);
@@ -0,0 +1,120 @@
+#include "SemmetyFrameHypr.hpp"
+
+#include <hyprland/src/config/ConfigManager.hpp>
+#include <hyprland/src/config/ConfigValue.hpp>
+#include <hyprland/src/config/shared/animation/AnimationTree.hpp>
+#include <hyprland/src/config/shared/workspace/WorkspaceRuleManager.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprland/src/render/Renderer.hpp>
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+
+#include "utils.hpp"
+
+SP<SemmetyHyprLeafFrame> SemmetyHyprLeafFrame::create(std::optional<bool> isActive) {
+	auto ptr = makeShared<SemmetyHyprLeafFrame>(isActive);
+	ptr->self = ptr;
+	return ptr;
+}
+
+SemmetyHyprLeafFrame::SemmetyHyprLeafFrame(std::optional<bool> isActive):
+    SemmetyLeafFrame(SemmetyWindowRef {}) {
+	// In Hyprland 0.55 gradient config values are read via CConfigValue<Config::IComplexConfigValue>,
+	// whose ptr() already returns the (CGradientValueData) data. The old CUSTOMTYPE + ->getData()
+	// idiom returns a bad pointer and crashes.
+	static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
+	static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
+
+	g_pAnimationManager->createAnimation(
+	    0.f,
+	    this->m_fBorderFadeAnimationProgress,
+	    Config::animationTree()->getAnimationPropertyConfig("border"),
+	    AVARDAMAGE_ENTIRE
+	);
+
+	Config::CGradientValueData* color;
+	if (isActive.value_or(false)) {
+		color = (Config::CGradientValueData*) PACTIVECOL.ptr();
+	} else {
+		color = (Config::CGradientValueData*) PINACTIVECOL.ptr();
+	}
+
+	m_cRealBorderColor = *color;
+}
+
+CBox getStandardWindowArea(
+    const SemmetyLeafFrame& frame,
+    CBox area,
+    SBoxExtents extents,
+    PHLWORKSPACE workspace
+) {
+	static const auto p_gaps_in = ConfigValue<Hyprlang::CUSTOMTYPE, Config::CCssGapData>("general:gaps_in");
+
+	auto workspace_rule = Config::workspaceRuleMgr()->getWorkspaceRuleFor(workspace);
+	Config::CCssGapData gaps_in = *p_gaps_in;
+	if (workspace_rule && workspace_rule->m_gapsIn) { gaps_in = *workspace_rule->m_gapsIn; }
+
+	SBoxExtents inner_gap_extents;
+	inner_gap_extents.topLeft = Vector2D((int) -gaps_in.m_left, (int) -gaps_in.m_top);
+	inner_gap_extents.bottomRight = Vector2D((int) -gaps_in.m_right, (int) -gaps_in.m_bottom);
+
+	SBoxExtents combined_outer_extents;
+	combined_outer_extents.topLeft = -frame.gap_topleft_offset;
+	combined_outer_extents.bottomRight = -frame.gap_bottomright_offset;
+
+	// auto area = this->geometry;
+	area.addExtents(inner_gap_extents);
+	area.addExtents(combined_outer_extents);
+	area.addExtents(extents);
+
+	area.round();
+	return area;
+}
+
+// from void CCompositor::updateWindowAnimatedDecorationValues(PHLWINDOW pWindow) {
+void SemmetyHyprLeafFrame::setBorderColor(Config::CGradientValueData grad) {
+	if (grad == m_cRealBorderColor) { return; }
+
+	m_cRealBorderColorPrevious = m_cRealBorderColor;
+	m_cRealBorderColor = grad;
+	m_fBorderFadeAnimationProgress->setValueAndWarp(0.f);
+	*m_fBorderFadeAnimationProgress = 1.f;
+}
+
+// from CHyprBorderDecoration::draw
+CBox SemmetyHyprLeafFrame::getEmptyFrameBox(const CMonitor& monitor) {
+	static auto PBORDERSIZE = CConfigValue<Hyprlang::INT>("general:border_size");
+
+	const auto borderSize = static_cast<int>(-*PBORDERSIZE);
+	const auto borderOffset = Vector2D(borderSize, borderSize);
+	const auto borderExtent = SBoxExtents {borderOffset, borderOffset};
+
+	const auto workspace = monitor.m_activeWorkspace;
+	// do we need to worry about m_vRenderOffset being animated if we are getting the frame box for
+	// damage?
+	// PWINDOWWORKSPACE->m_vRenderOffset->isBeingAnimated()
+	const auto workspaceOffset = workspace ? workspace->m_renderOffset->value() : Vector2D();
+
+	auto frameBox = getStandardWindowArea(*this, this->geometry, borderExtent, workspace);
+
+	return frameBox.translate(-monitor.m_position + workspaceOffset).scale(monitor.m_scale).round();
+}
+
+void SemmetyHyprLeafFrame::damageEmptyFrameBox(const CMonitor& monitor) {
+	static auto PROUNDING = CConfigValue<Hyprlang::INT>("decoration:rounding");
+
+	const auto rounding = static_cast<float>(*PROUNDING);
+	const auto roundingSize = rounding - M_SQRT1_2 * rounding + 2;
+
+	const auto frameBox = this->getEmptyFrameBox(monitor);
+
+	CBox surfaceBoxShrunkRounding = frameBox;
+	surfaceBoxShrunkRounding.expand(-roundingSize);
+
+	CRegion borderRegion(frameBox);
+	borderRegion.subtract(surfaceBoxShrunkRounding);
+
+	// TODO: try to damage less
+	// g_pHyprRenderer->damageRegion(borderRegion);
+	g_pHyprRenderer->damageRegion(this->geometry);
+}
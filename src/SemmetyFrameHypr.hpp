@@ -0,0 +1,38 @@
+#pragma once
+
+#include <optional>
+
+#include <hyprland/src/config/shared/complex/ComplexDataTypes.hpp>
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+#include <hyprutils/math/Box.hpp>
+
+#include "SemmetyFrame.hpp"
+#include "src/helpers/AnimatedVariable.hpp"
+
+// A leaf frame that also draws a border while it is empty, fading between the active and inactive
+// colours like Hyprland does for windows.
+class SemmetyHyprLeafFrame: public SemmetyLeafFrame {
+public:
+	static SP<SemmetyHyprLeafFrame> create(std::optional<bool> isActive = std::nullopt);
+	Config::CGradientValueData m_cRealBorderColor = {0};
+	Config::CGradientValueData m_cRealBorderColorPrevious = {0};
+	PHLANIMVAR<float> m_fBorderFadeAnimationProgress;
+
+	void setBorderColor(Config::CGradientValueData grad);
+	void damageEmptyFrameBox(const CMonitor& monitor);
+	CBox getEmptyFrameBox(const CMonitor& monitor);
+
+private:
+	SemmetyHyprLeafFrame(std::optional<bool> isActive = std::nullopt);
+
+	template <typename U, typename... Args>
+	friend Hyprutils::Memory::CSharedPointer<U> Hyprutils::Memory::makeShared(Args&&...);
+};
+
+// The area a window in `frame` gets out of `area`, after the gaps and `extents`.
+CBox getStandardWindowArea(
+    const SemmetyLeafFrame& frame,
+    CBox area,
+    SBoxExtents extents,
+    PHLWORKSPACE workspace
+);
@@ -1,15 +1,15 @@
 #include "SemmetyFrameUtils.hpp"
 #include <algorithm>
+#include <cctype>
+#include <format>
+#include <iterator>
+#include <limits>
 #include <numeric>
+#include <sstream>
 
-#include "SemmetyWorkspaceWrapper.hpp"
-#include "log.hpp"
+#include "SemmetyError.hpp"
 
-void replaceNode(
-    SP<SemmetyFrame> target,
-    SP<SemmetyFrame> source,
-    SemmetyWorkspaceWrapper& workspace
-) {
+void replaceNode(SP<SemmetyFrame> target, SP<SemmetyFrame> source, SemmetyWorkspace& workspace) {
 	auto* slot = &workspace.root;
 	std::vector<int> targetPath = {}; // Path to target's position
 
@@ -93,7 +93,7 @@ findParentRecursive(const SP<SemmetyFrame> current, const SP<SemmetyFrame> targe
 // Find the parent of a node in the workspace.
 // If 'target' is the root, returns nullptr.
 SP<SemmetySplitFrame>
-findParent(const SP<SemmetyFrame> target, SemmetyWorkspaceWrapper& workspace) {
+findParent(const SP<SemmetyFrame> target, SemmetyWorkspace& workspace) {
 	if (workspace.getRoot() == target) { return nullptr; }
 
 	if (auto res = findParentRecursive(workspace.getRoot(), target)) { return res; }
@@ -121,7 +121,7 @@ bool overlap(int start1, int end1, int start2, int end2) {
 }
 
 SP<SemmetyLeafFrame> getNeighborByDirection(
-    const SemmetyWorkspaceWrapper& workspace,
+    const SemmetyWorkspace& workspace,
     const SP<SemmetyLeafFrame> basis,
     const Direction dir
 ) {
@@ -208,10 +208,10 @@ SP<SemmetyLeafFrame> getNeighborByDirection(
 }
 
 SP<SemmetyLeafFrame>
-getMostOverlappingLeafFrame(SemmetyWorkspaceWrapper& workspace, const PHLWINDOWREF& window) {
+getMostOverlappingLeafFrame(SemmetyWorkspace& workspace, const SemmetyWindowRef& window) {
 	if (!window) { return nullptr; }
 
-	const auto windowBox = CBox(window->m_position, window->m_size);
+	const auto windowBox = window->box();
 
 	double maxOverlapArea = 0.0;
 	SP<SemmetyLeafFrame> bestFrame = nullptr;
@@ -265,11 +265,8 @@ bool getPathNodes(
 	return false;
 }
 
-SP<SemmetySplitFrame> getCommonParent(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyFrame> frameA,
-    SP<SemmetyFrame> frameB
-) {
+SP<SemmetySplitFrame>
+getCommonParent(SemmetyWorkspace& workspace, SP<SemmetyFrame> frameA, SP<SemmetyFrame> frameB) {
 	std::vector<SP<SemmetyFrame>> pathA, pathB;
 	if (!getPathNodes(frameA, workspace.getRoot(), pathA)) {
 		semmety_critical_error("Frame A not found in the tree");
@@ -298,7 +295,7 @@ SP<SemmetySplitFrame> getCommonParent(
 }
 
 SP<SemmetySplitFrame> getResizeTarget(
-    SemmetyWorkspaceWrapper& workspace,
+    SemmetyWorkspace& workspace,
     SP<SemmetyLeafFrame> frame,
     Direction posDirection,
     Direction negDirection
@@ -330,7 +327,7 @@ SP<SemmetySplitFrame> getResizeTarget(
 }
 
 SP<SemmetySplitFrame>
-getResizeTarget(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame> basis, Direction dir) {
+getResizeTarget(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> basis, Direction dir) {
 	auto neighbor = getNeighborByDirection(workspace, basis, dir);
 	if (!neighbor) { return {}; }
 
@@ -390,3 +387,103 @@ std::string getFramePath(const SP<SemmetyFrame>& targetFrame, const SP<SemmetyFr
 	}
 	return oss.str();
 }
+
+void resizeFrame(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> frame,
+    Vector2D delta,
+    ResizeCorner corner
+) {
+	auto resizeDelta = delta;
+	SP<SemmetySplitFrame> horizontalParent, verticalParent;
+
+	switch (corner) {
+	case ResizeCorner::TopLeft:
+		horizontalParent = getResizeTarget(workspace, frame, Direction::Left);
+		verticalParent = getResizeTarget(workspace, frame, Direction::Up);
+		resizeDelta.x *= -1;
+		resizeDelta.y *= -1;
+		break;
+	case ResizeCorner::TopRight:
+		horizontalParent = getResizeTarget(workspace, frame, Direction::Right);
+		verticalParent = getResizeTarget(workspace, frame, Direction::Up);
+		resizeDelta.y *= -1;
+		break;
+	case ResizeCorner::BottomRight:
+		horizontalParent = getResizeTarget(workspace, frame, Direction::Right);
+		verticalParent = getResizeTarget(workspace, frame, Direction::Down);
+		break;
+	case ResizeCorner::BottomLeft:
+		horizontalParent = getResizeTarget(workspace, frame, Direction::Left);
+		verticalParent = getResizeTarget(workspace, frame, Direction::Down);
+		resizeDelta.x *= -1;
+		break;
+	case ResizeCorner::None:
+		horizontalParent = getResizeTarget(workspace, frame, Direction::Left, Direction::Right);
+		verticalParent = getResizeTarget(workspace, frame, Direction::Up, Direction::Down);
+		break;
+	}
+
+	if (!horizontalParent && !verticalParent) { return; }
+
+	if (horizontalParent) {
+		if (horizontalParent->getChildren().second->isSameOrDescendant(frame)) { resizeDelta.x *= -1; }
+
+		horizontalParent->resize(resizeDelta.x);
+	}
+
+	if (verticalParent) {
+		if (verticalParent->getChildren().second->isSameOrDescendant(frame)) { resizeDelta.y *= -1; }
+
+		verticalParent->resize(resizeDelta.y);
+	}
+
+	SP<SemmetyFrame> commonParent;
+	if (!horizontalParent) {
+		commonParent = verticalParent;
+	} else if (!verticalParent) {
+		commonParent = horizontalParent;
+	} else {
+		commonParent = getCommonParent(workspace, horizontalParent, verticalParent);
+	}
+
+	commonParent->applyRecursive(workspace, std::nullopt, true);
+}
+
+std::string getGeometryString(const CBox geometry) {
+	return std::format(
+	    "{}, {}, {}, {}",
+	    geometry.pos().x,
+	    geometry.pos().y,
+	    geometry.size().x,
+	    geometry.size().y
+	);
+}
+
+std::string directionToString(const Direction dir) {
+	switch (dir) {
+	case Direction::Up: return "Up";
+	case Direction::Down: return "Down";
+	case Direction::Left: return "Left";
+	case Direction::Right: return "Right";
+	default: return "Unknown";
+	}
+}
+
+std::string toLower(const std::string& str) {
+	std::string result;
+	std::transform(str.begin(), str.end(), std::back_inserter(result), [](unsigned char c) {
+		return std::tolower(c);
+	});
+	return result;
+}
+
+std::optional<Direction> directionFromString(const std::string& str) {
+	const auto lowerStr = toLower(str);
+
+	if (lowerStr == "l" || lowerStr == "left") return Direction::Left;
+	else if (lowerStr == "r" || lowerStr == "right") return Direction::Right;
+	else if (lowerStr == "u" || lowerStr == "up") return Direction::Up;
+	else if (lowerStr == "d" || lowerStr == "down") return Direction::Down;
+	else return {};
+}
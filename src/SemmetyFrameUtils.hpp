@@ -1,27 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "SemmetyFrame.hpp"
-#include "utils.hpp"
+#include "SemmetyWorkspace.hpp"
 
-SP<SemmetySplitFrame> findParent(const SP<SemmetyFrame> target, SemmetyWorkspaceWrapper& workspace);
-void replaceNode(
-    SP<SemmetyFrame> target,
-    SP<SemmetyFrame> source,
-    SemmetyWorkspaceWrapper& workspace
-);
+enum class Direction { Up, Right, Down, Left };
+// The corner a resize drags, None for resizes without a corner like resizeactive.
+enum class ResizeCorner { None, TopLeft, TopRight, BottomRight, BottomLeft };
+
+SP<SemmetySplitFrame> findParent(const SP<SemmetyFrame> target, SemmetyWorkspace& workspace);
+void replaceNode(SP<SemmetyFrame> target, SP<SemmetyFrame> source, SemmetyWorkspace& workspace);
 void updateFramePathsRecursive(SP<SemmetyFrame> frame, const std::vector<int>& newPath);
 SP<SemmetyLeafFrame> getMaxFocusOrderLeaf(const std::vector<SP<SemmetyLeafFrame>> leafFrames);
 SP<SemmetyLeafFrame> getNeighborByDirection(
-    const SemmetyWorkspaceWrapper& workspace,
+    const SemmetyWorkspace& workspace,
     const SP<SemmetyLeafFrame> basis,
     const Direction dir
 );
 SP<SemmetyLeafFrame>
-getMostOverlappingLeafFrame(SemmetyWorkspaceWrapper& workspace, const PHLWINDOWREF& window);
+getMostOverlappingLeafFrame(SemmetyWorkspace& workspace, const SemmetyWindowRef& window);
 bool frameAreaGreater(const SP<SemmetyLeafFrame>& a, const SP<SemmetyLeafFrame>& b);
 std::string getFramePath(const SP<SemmetyFrame>& targetFrame, const SP<SemmetyFrame>& rootFrame);
 SP<SemmetySplitFrame>
-getResizeTarget(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame> basis, Direction dir);
+getResizeTarget(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> basis, Direction dir);
 SP<SemmetySplitFrame> getResizeTarget(
-    SemmetyWorkspaceWrapper& workspace,
+    SemmetyWorkspace& workspace,
     SP<SemmetyLeafFrame> frame,
     Direction posDirection,
     Direction negDirection
@@ -31,8 +37,16 @@ bool getPathNodes(
     const SP<SemmetyFrame>& current,
     std::vector<SP<SemmetyFrame>>& path
 );
-SP<SemmetySplitFrame> getCommonParent(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyFrame> frameA,
-    SP<SemmetyFrame> frameB
+SP<SemmetySplitFrame>
+getCommonParent(SemmetyWorkspace& workspace, SP<SemmetyFrame> frameA, SP<SemmetyFrame> frameB);
+// Resizes the splits around `frame` by `delta` and reflows them.
+void resizeFrame(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> frame,
+    Vector2D delta,
+    ResizeCorner corner
 );
+std::string getGeometryString(const CBox geometry);
+std::string toLower(const std::string& str);
+std::optional<Direction> directionFromString(const std::string& str);
+std::string directionToString(const Direction dir);
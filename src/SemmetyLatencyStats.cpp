@@ -0,0 +1,90 @@
+#include "SemmetyLatencyStats.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+//
+// SemmetyHistogram
+//
+
+size_t SemmetyHistogram::bucketIndex(uint64_t value) {
+	if (value < SUB_BUCKETS) { return value; }
+
+	// the top SUB_BUCKET_BITS + 1 bits of the value pick the bucket within its power of two
+	const auto shift = std::bit_width(value) - 1 - SUB_BUCKET_BITS;
+	return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+}
+
+uint64_t SemmetyHistogram::bucketUpperBound(size_t index) {
+	if (index < SUB_BUCKETS) { return index; }
+
+	const auto shift = index / SUB_BUCKETS - 1;
+	const auto lower = (uint64_t) (index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+	return lower + ((uint64_t) 1 << shift) - 1;
+}
+
+void SemmetyHistogram::record(uint64_t value) {
+	m_buckets[bucketIndex(value)] += 1;
+	m_count += 1;
+	m_total += value;
+	m_max = std::max(m_max, value);
+}
+
+uint64_t SemmetyHistogram::percentile(double p) const {
+	if (m_count == 0) { return 0; }
+
+	const auto rank = std::max<uint64_t>(1, std::ceil(p * m_count));
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < m_buckets.size(); i++) {
+		seen += m_buckets[i];
+		if (seen >= rank) { return std::min(bucketUpperBound(i), m_max); }
+	}
+
+	return m_max;
+}
+
+//
+// SemmetyLatencyStats
+//
+
+void SemmetyLatencyStats::record(const std::string& name, uint64_t ns, uint64_t checksNs) {
+	std::lock_guard lock(m_mutex);
+
+	auto& entry = m_entries[name];
+	entry.latency.record(ns);
+	entry.checksNs += checksNs;
+	entry.checksMaxNs = std::max(entry.checksMaxNs, checksNs);
+}
+
+void SemmetyLatencyStats::reset() {
+	std::lock_guard lock(m_mutex);
+	m_entries.clear();
+}
+
+json SemmetyLatencyStats::toJson() const {
+	// copy under the lock and walk the buckets after, so record() on the compositor thread only
+	// waits for the copy
+	std::vector<std::pair<std::string, SEntry>> entries;
+	{
+		std::lock_guard lock(m_mutex);
+		entries.assign(m_entries.begin(), m_entries.end());
+	}
+
+	json out = json::object();
+	for (const auto& [name, entry]: entries) {
+		out[name] = {
+		    {"count", entry.latency.count()},
+		    {"p50Ns", entry.latency.percentile(0.5)},
+		    {"p99Ns", entry.latency.percentile(0.99)},
+		    {"maxNs", entry.latency.max()},
+		    {"totalNs", entry.latency.total()},
+		    {"checksNs", entry.checksNs},
+		    {"checksMaxNs", entry.checksMaxNs},
+		};
+	}
+
+	return out;
+}
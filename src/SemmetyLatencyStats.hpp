@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "SemmetyClock.hpp"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+// Log-linear histogram of nanosecond values, like HdrHistogram: values below 16 get a bucket each,
+// every power of two above is split into 16 buckets, so percentiles are within 1/16 of the value.
+class SemmetyHistogram {
+public:
+	void record(uint64_t value);
+	// The upper end of the bucket holding the value at `p` (0..1), never above max().
+	uint64_t percentile(double p) const;
+
+	uint64_t count() const { return m_count; }
+	uint64_t total() const { return m_total; }
+	uint64_t max() const { return m_max; }
+
+private:
+	static constexpr int SUB_BUCKET_BITS = 4;
+	static constexpr size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+	static size_t bucketIndex(uint64_t value);
+	static uint64_t bucketUpperBound(size_t index);
+
+	std::array<uint64_t, (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS> m_buckets {};
+	uint64_t m_count = 0;
+	uint64_t m_total = 0;
+	uint64_t m_max = 0;
+};
+
+// How long each entryWrapper() entry point took, recorded on the compositor thread and read by the
+// socket's stats command on the I/O thread.
+class SemmetyLatencyStats {
+public:
+	// `checksNs` is the part of `ns` spent in the invariant checks and the debug snapshot around
+	// the outermost entry.
+	void record(const std::string& name, uint64_t ns, uint64_t checksNs);
+	void reset();
+	// {name: {"count", "p50Ns", "p99Ns", "maxNs", "totalNs", "checksNs", "checksMaxNs"}}
+	json toJson() const;
+
+private:
+	struct SEntry {
+		SemmetyHistogram latency;
+		uint64_t checksNs = 0;
+		uint64_t checksMaxNs = 0;
+	};
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<std::string, SEntry> m_entries;
+};
+
+inline SemmetyLatencyStats g_semmetyLatencyStats;
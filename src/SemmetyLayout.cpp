@@ -1,8 +1,11 @@
 #include "SemmetyLayout.hpp"
 #include <optional>
+#include <string_view>
 
+#include <hyprland/src/config/ConfigValue.hpp>
 #include <hyprland/src/desktop/state/FocusState.hpp>
 
+#include "SemmetyWindowHypr.hpp"
 #include "SemmetyWorkspaceWrapper.hpp"
 #include "log.hpp"
 #include "src/globals.hpp"
@@ -13,63 +16,149 @@ SemmetyWorkspaceWrapper& SemmetyLayout::getOrCreateWorkspaceWrapper(PHLWORKSPACE
 		semmety_critical_error("Tring to get or create a workspace wrapper with an invalid workspace");
 	}
 
-	for (auto& wrapper: this->workspaceWrappers) {
-		if (wrapper.workspace.get() == &*workspace) { return wrapper; }
-	}
+	if (auto* wrapper = findWorkspaceWrapper(workspace)) { return *wrapper; }
 
-	semmety_log(Log::ERR, "Creating new workspace wrapper for workspace {}", workspace->m_id);
+	semmety_log(
+	    Layout,
+	    Log::INFO,
+	    "Creating new workspace wrapper for workspace {}",
+	    workspace->m_id
+	);
 	auto ww = SemmetyWorkspaceWrapper(workspace, *this);
 
 	this->workspaceWrappers.emplace_back(ww);
+
+	if (trace.isOpen()) {
+		trace.write({
+		    .event = SemmetyTraceEvent::Workspace,
+		    .workspace = workspace->m_id,
+		    .box = ww.getRoot()->geometry,
+		});
+	}
+
 	return this->workspaceWrappers.back();
 }
 
-json SemmetyLayout::getWorkspacesJson() {
-	const auto ws = workspace_for_action();
-
-	json jsonWorkspaces = json::array();
-	for (int workspaceIndex = 0; workspaceIndex < 8; workspaceIndex++) {
-		auto it = std::find_if(
-		    workspaceWrappers.begin(),
-		    workspaceWrappers.end(),
-		    [workspaceIndex](const auto& workspaceWrapper) {
-			    return workspaceWrapper.workspace != nullptr
-			        && workspaceWrapper.workspace->m_id == workspaceIndex + 1;
-		    }
-		);
+SemmetyWorkspaceWrapper* SemmetyLayout::findWorkspaceWrapper(const PHLWORKSPACE& workspace) {
+	if (workspace == nullptr) { return nullptr; }
 
-		if (it == workspaceWrappers.end()) {
-			jsonWorkspaces.push_back(
-			    {{"id", workspaceIndex + 1},
-			     {"numWindows", 0},
-			     {"name", ""},
-			     {"focused", false},
-			     {"urgent", false}}
-			);
+	for (auto& wrapper: this->workspaceWrappers) {
+		if (wrapper.workspace.get() == &*workspace) { return &wrapper; }
+	}
 
-			continue;
+	return nullptr;
+}
+
+void SemmetyLayout::startTrace(const std::string& path) {
+	if (!trace.open(path)) {
+		semmety_log(Layout, Log::ERR, "could not open trace file {}", path);
+		return;
+	}
+
+	semmety_log(Layout, Log::INFO, "recording a trace to {}", path);
+
+	// Workspaces that already exist are replayed as empty ones that get their windows added in
+	// order. Their splits are lost, so traces are best started before any window is managed.
+	for (auto& wrapper: workspaceWrappers) {
+		const auto workspaceId = wrapper.workspace ? wrapper.workspace->m_id : WORKSPACE_INVALID;
+
+		trace.write({
+		    .event = SemmetyTraceEvent::Workspace,
+		    .workspace = workspaceId,
+		    .box = wrapper.getRoot()->geometry,
+		});
+
+		for (const auto& window: wrapper.windows) {
+			trace.write({
+			    .event = SemmetyTraceEvent::NewTarget,
+			    .workspace = workspaceId,
+			    .window = window->id(),
+			    .flag = window->isFloating(),
+			});
 		}
+	}
+}
 
-		jsonWorkspaces.push_back(
-		    {{"id", workspaceIndex + 1},
-		     {"numWindows", it->windows.size()},
-		     {"name", it->workspace->m_name},
-		     {"urgent", it->workspace->hasUrgentWindow()},
-		     {"focused", &(*it) == &(*ws)}}
-		);
+void SemmetyLayout::stopTrace() {
+	if (!trace.isOpen()) { return; }
+
+	for (auto& wrapper: workspaceWrappers) {
+		trace.write({
+		    .event = SemmetyTraceEvent::Hash,
+		    .workspace = wrapper.workspace ? wrapper.workspace->m_id : WORKSPACE_INVALID,
+		    .hash = hashWorkspaceTree(wrapper),
+		});
+	}
+
+	trace.close();
+}
+
+std::vector<SemmetyBarWorkspace> SemmetyLayout::getBarWorkspaces() {
+	static auto PWORKSPACES = ConfigValue<Hyprlang::STRING>("plugin:semmety:bar_workspaces");
+	const bool ALL = std::string_view(*PWORKSPACES) == "all";
+
+	// focused is the workspace actions go to, as in workspace_for_action(), so there is only one
+	const auto focusedMonitor = Desktop::focusState()->monitor();
+	PHLWORKSPACE focusedWorkspace;
+	if (focusedMonitor) {
+		focusedWorkspace = valid(focusedMonitor->m_activeSpecialWorkspace)
+		                     ? focusedMonitor->m_activeSpecialWorkspace
+		                     : focusedMonitor->m_activeWorkspace;
+	}
+
+	std::vector<SemmetyBarWorkspace> barWorkspaces;
+	barWorkspaces.reserve(ALL ? workspaceWrappers.size() : 8);
+
+	// the original shape: workspaces 1 to 8, with placeholders for the ones that don't exist
+	if (!ALL) {
+		for (int id = 1; id <= 8; id++) { barWorkspaces.push_back({.id = id}); }
+	}
+
+	for (auto& wrapper: workspaceWrappers) {
+		const auto workspace = wrapper.workspace.lock();
+		if (!workspace) { continue; }
+		if (!ALL && (workspace->m_id < 1 || workspace->m_id > 8)) { continue; }
+
+		const auto monitor = workspace->m_monitor.lock();
+		const bool visible = monitor
+		                  && (monitor->m_activeWorkspace == workspace
+		                      || monitor->m_activeSpecialWorkspace == workspace);
+
+		SemmetyBarWorkspace barWorkspace {
+		    .id = (int) workspace->m_id,
+		    .name = workspace->m_name,
+		    .monitor = monitor ? monitor->m_name : "",
+		    .numWindows = wrapper.windows.size(),
+		    .focused = workspace == focusedWorkspace,
+		    .visible = visible,
+		    .urgent = wrapper.hasUrgentWindow(),
+		};
+
+		if (ALL) {
+			barWorkspaces.push_back(std::move(barWorkspace));
+		} else {
+			barWorkspaces[workspace->m_id - 1] = std::move(barWorkspace);
+		}
 	}
 
-	return jsonWorkspaces;
+	if (ALL) { std::ranges::sort(barWorkspaces, {}, &SemmetyBarWorkspace::id); }
+	return barWorkspaces;
 }
 
 void SemmetyLayout::activateWindow(PHLWINDOW window) {
 	if (entryCount > 0) { return; }
 
 	entryWrapper("activateWindow", [&]() -> std::optional<std::string> {
+		SemmetyFlightEntry::note(
+		    window->m_workspace ? window->m_workspace->m_id : 0,
+		    0,
+		    (uintptr_t) window.get()
+		);
+
 		auto layout = g_SemmetyLayout;
-		auto ww = layout->getOrCreateWorkspaceWrapper(window->m_workspace);
+		auto& ww = layout->getOrCreateWorkspaceWrapper(window->m_workspace);
 
-		ww.activateWindow(window);
+		ww.activateWindow(toSemmetyWindow(window));
 
 		shouldUpdateBar();
 		g_pAnimationManager->scheduleTick();
@@ -86,6 +175,8 @@ void SemmetyLayout::moveWindowToWorkspace(std::string wsname) {
 		const auto sourceWorkspace = focused_window->m_workspace;
 		if (!sourceWorkspace) { return "no source workspace"; }
 
+		SemmetyFlightEntry::note(sourceWorkspace->m_id, 0, (uintptr_t) focused_window.get());
+
 		auto target = getWorkspaceIDNameFromString(wsname);
 		if (target.id == WORKSPACE_INVALID) {
 			return format("moveNodeToWorkspace called with invalid workspace {}", wsname);
@@ -93,7 +184,7 @@ void SemmetyLayout::moveWindowToWorkspace(std::string wsname) {
 
 		auto targetWorkspace = g_pCompositor->getWorkspaceByID(target.id);
 		if (!targetWorkspace) {
-			semmety_log(Log::INFO, "creating target workspace {} for node move", target.id);
+			semmety_log(Layout, Log::INFO, "creating target workspace {} for node move", target.id);
 
 			targetWorkspace =
 			    g_pCompositor->createNewWorkspace(target.id, sourceWorkspace->monitorID(), target.name);
@@ -104,11 +195,11 @@ void SemmetyLayout::moveWindowToWorkspace(std::string wsname) {
 
 		if (sourceWorkspace == targetWorkspace) { return "source and target workspaces are the same"; }
 
-		auto sourceWrapper = getOrCreateWorkspaceWrapper(sourceWorkspace);
-		auto targetWrapper = getOrCreateWorkspaceWrapper(targetWorkspace);
+		auto& sourceWrapper = getOrCreateWorkspaceWrapper(sourceWorkspace);
+		getOrCreateWorkspaceWrapper(targetWorkspace);
 
 		g_pCompositor->moveWindowToWorkspaceSafe(focused_window, targetWorkspace);
-		sourceWrapper.removeWindow(focused_window);
+		sourceWrapper.removeWindow(toSemmetyWindow(focused_window));
 
 		g_pHyprRenderer->damageWindow(focused_window);
 
@@ -122,8 +213,8 @@ void SemmetyLayout::testWorkspaceInvariance() {
 		auto errors = ws.testInvariants();
 		if (errors.empty()) { continue; }
 
-		semmety_log(Log::ERR, "Found {} errors", errors.size());
-		for (auto& error: errors) { semmety_log(Log::ERR, "{}", error); }
+		semmety_log(Layout, Log::ERR, "Found {} errors", errors.size());
+		for (auto& error: errors) { semmety_log(Layout, Log::ERR, "{}", error); }
 
 		ws.printDebug();
 		semmety_critical_error("invariant failed");
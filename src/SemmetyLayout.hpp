@@ -7,6 +7,12 @@
 #include <hyprland/src/layout/algorithm/TiledAlgorithm.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
 
+#include "SemmetyAllocStats.hpp"
+#include "SemmetyFlightRecorder.hpp"
+#include "SemmetyLatencyStats.hpp"
+#include "SemmetyPerfCounters.hpp"
+#include "SemmetySpans.hpp"
+#include "SemmetyTrace.hpp"
 #include "SemmetyWorkspaceWrapper.hpp"
 #include "json.hpp"
 #include "log.hpp"
@@ -62,55 +68,76 @@ public:
 	void moveWindowToWorkspace(std::string wsname);
 	void recalculateWorkspace(const PHLWORKSPACE& workspace);
 	SemmetyWorkspaceWrapper& getOrCreateWorkspaceWrapper(PHLWORKSPACE workspace);
+	// nullptr if the workspace has no wrapper yet.
+	SemmetyWorkspaceWrapper* findWorkspaceWrapper(const PHLWORKSPACE& workspace);
 
 	inline static std::list<SemmetyWorkspaceWrapper> workspaceWrappers;
 	inline static bool updateBarOnNextTick = false;
 
+	// Entry points are recorded here while tracing, see SemmetyTrace.hpp and semmety-replay.
+	inline static SemmetyTraceWriter trace;
+	static void startTrace(const std::string& path);
+	static void stopTrace();
+
 	void activateWindow(PHLWINDOW window);
 	void changeWindowOrder(bool prev);
-	json getWorkspacesJson();
+	std::vector<SemmetyBarWorkspace> getBarWorkspaces();
 
 	std::string getDebugString();
 	void testWorkspaceInvariance();
 
 	template <typename Fn>
 	auto entryWrapper(std::string name, Fn&& fn) {
-		semmety_log(Log::ERR, "ENTER {} {}", name, entryCount);
+		semmety_trace(Dispatch, "ENTER {} {}", name, entryCount);
+
+		const SemmetySpan span(name);
+		SemmetyFlightEntry flight(name);
+		const SemmetyAllocScope allocs(name, eSemmetyAllocTable::EntryPoint);
+		const SemmetyPerfScope perf(name, eSemmetyPerfTable::EntryPoint);
+		const auto start = semmetyMonotonicNs();
+		uint64_t checksNs = 0;
 
 		if (entryCount == 0) {
 			testWorkspaceInvariance();
 			debugStringOnEntry = getDebugString();
+			checksNs += semmetyMonotonicNs() - start;
 		}
 
-		entryCount += 1;
-
 		using ReturnType = std::invoke_result_t<Fn>;
 		std::optional<ReturnType> result;
 		std::optional<std::string> exitMessage;
 
-		if constexpr (std::is_same_v<ReturnType, std::optional<std::string>>) {
-			result = fn();
-			if (result->has_value()) { exitMessage = result.value(); }
-		} else if constexpr (std::is_void_v<ReturnType>) {
-			fn();
-		} else {
-			result = fn();
-		}
+		{
+			const SEntryDepth depth;
 
-		if (entryCount == 1) {
-			testWorkspaceInvariance();
-			if (_shouldUpdateBar) {
-				updateBar();
-				_shouldUpdateBar = false;
+			if constexpr (std::is_same_v<ReturnType, std::optional<std::string>>) {
+				result = fn();
+				if (result->has_value()) { exitMessage = result.value(); }
+			} else if constexpr (std::is_void_v<ReturnType>) {
+				fn();
+			} else {
+				result = fn();
+			}
+
+			if (entryCount == 1) {
+				const auto checksStart = semmetyMonotonicNs();
+				testWorkspaceInvariance();
+				checksNs += semmetyMonotonicNs() - checksStart;
+
+				if (_shouldUpdateBar) {
+					updateBar();
+					_shouldUpdateBar = false;
+				}
 			}
 		}
 
-		entryCount -= 1;
+		g_semmetyLatencyStats.record(name, semmetyMonotonicNs() - start, checksNs);
+		flight.finish(exitMessage.has_value());
 
 		if (exitMessage.has_value()) {
-			semmety_log(Log::INFO, "EXIT {} -- {}", name, exitMessage.value());
+			semmety_log(Dispatch, Log::INFO, "EXIT {} -- {}", name, exitMessage.value());
 		} else {
-			semmety_log(Log::INFO, "EXIT {}", name);
+			semmety_trace(Dispatch, "EXIT {}", name);
 		}
 
 		if constexpr (!std::is_void_v<ReturnType>) { return *result; }
@@ -120,4 +147,21 @@ public:
 
 	inline static int entryCount = 0;
 	inline static std::string debugStringOnEntry = "";
+
+	// Counts a running entry point in entryCount and the log indent, and takes it off again even
+	// when the entry point throws (semmety_critical_error does).
+	struct SEntryDepth {
+		SEntryDepth() {
+			entryCount += 1;
+			t_semmetyLogIndent += 1;
+		}
+
+		~SEntryDepth() {
+			entryCount -= 1;
+			t_semmetyLogIndent -= 1;
+		}
+
+		SEntryDepth(const SEntryDepth&) = delete;
+		SEntryDepth& operator=(const SEntryDepth&) = delete;
+	};
 };
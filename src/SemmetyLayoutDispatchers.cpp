@@ -0,0 +1,119 @@
+#include "SemmetyLayoutDispatchers.hpp"
+#include <format>
+
+#include <hyprutils/memory/SharedPtr.hpp>
+
+#include "SemmetyFrameUtils.hpp"
+
+std::optional<std::string>
+dispatchSplit(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList) {
+	auto firstChild = focussedFrame;
+
+	auto secondChild = workspace.createLeafFrame();
+	auto newSplit = SemmetySplitFrame::create(firstChild, secondChild, focussedFrame->geometry);
+
+	replaceNode(focussedFrame, newSplit, workspace);
+	workspace.setFocusedFrame(secondChild);
+
+	return std::nullopt;
+}
+
+std::optional<std::string> dispatchRemove(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> focussedFrame,
+    CVarList args
+) {
+	auto parent = findParent(focussedFrame, workspace);
+	if (!parent) { return "Frame has no parent, cannot remove the root frame!"; }
+
+	if (args[0] == "sibling") {
+		replaceNode(parent, focussedFrame, workspace);
+	} else {
+		auto remainingSibling = parent->getOtherChild(focussedFrame);
+		replaceNode(parent, remainingSibling, workspace);
+		workspace.setFocusedFrame(remainingSibling);
+	}
+
+	return std::nullopt;
+}
+
+std::optional<std::string> dispatchCycle(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> focussedFrame,
+    CVarList args
+) {
+	auto params = nextTiledWindowParams;
+	SemmetyWindowRef window;
+	if (args[0] == "prev") {
+		params.backward = true;
+		window = workspace.getNextWindow(params);
+	} else {
+		window = workspace.getNextWindow(params);
+	}
+
+	if (!window) { return std::nullopt; }
+
+	workspace.putWindowInFocussedFrame(window);
+
+	return std::nullopt;
+}
+
+std::optional<std::string> dispatchFocus(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> focussedFrame,
+    CVarList args
+) {
+	const auto direction = directionFromString(args[0]);
+	if (!direction.has_value()) {
+		// TODO: return error
+		return std::nullopt;
+	}
+
+	const auto neighbor = getNeighborByDirection(workspace, focussedFrame, direction.value());
+	if (!neighbor) { return std::nullopt; }
+
+	workspace.setFocusedFrame(neighbor);
+	return std::nullopt;
+}
+
+std::optional<std::string> dispatchSwap(
+    SemmetyWorkspace& workspace,
+    SP<SemmetyLeafFrame> focussedFrame,
+    CVarList args
+) {
+	const auto direction = directionFromString(args[0]);
+	if (!direction.has_value()) {
+		return std::format("Failed to pares direction from argument string '{}'", args[0]);
+	}
+
+	const auto neighbor = getNeighborByDirection(workspace, focussedFrame, direction.value());
+	if (!neighbor) { return std::nullopt; }
+
+	focussedFrame->swapContents(workspace, neighbor);
+	workspace.setFocusedFrame(neighbor);
+
+	return std::nullopt;
+}
+
+std::optional<std::string>
+dispatchChangeWindowOrder(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame>, CVarList args) {
+	if (args.size() == 0) { return "Expected 'prev' or 'next' as argument"; }
+
+	const bool prev = args[0] == "prev";
+	workspace.changeWindowOrder(prev);
+
+	return std::nullopt;
+}
+
+const std::unordered_map<std::string, SemmetyLayoutDispatcher>& getLayoutDispatchers() {
+	static const std::unordered_map<std::string, SemmetyLayoutDispatcher> dispatchers = {
+	    {"split", dispatchSplit},
+	    {"remove", dispatchRemove},
+	    {"cycle", dispatchCycle},
+	    {"focus", dispatchFocus},
+	    {"swap", dispatchSwap},
+	    {"changewindoworder", dispatchChangeWindowOrder},
+	};
+
+	return dispatchers;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/string/VarList.hpp>
+
+#include "SemmetyFrame.hpp"
+#include "SemmetyWorkspace.hpp"
+
+using Hyprutils::String::CVarList;
+
+// The dispatchers that only change the layout core. dispatchers.cpp registers them with Hyprland,
+// the replay tool runs them against the stand-in.
+
+using SemmetyLayoutDispatcher =
+    std::optional<std::string> (*)(SemmetyWorkspace&, SP<SemmetyLeafFrame>, CVarList);
+
+std::optional<std::string>
+dispatchSplit(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList);
+std::optional<std::string>
+dispatchRemove(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList args);
+std::optional<std::string>
+dispatchCycle(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList args);
+std::optional<std::string>
+dispatchFocus(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList args);
+std::optional<std::string>
+dispatchSwap(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList args);
+std::optional<std::string>
+dispatchChangeWindowOrder(SemmetyWorkspace& workspace, SP<SemmetyLeafFrame>, CVarList args);
+
+// By name, without the "semmety:" prefix.
+const std::unordered_map<std::string, SemmetyLayoutDispatcher>& getLayoutDispatchers();
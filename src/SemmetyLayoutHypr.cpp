@@ -17,8 +17,10 @@
 #include <hyprland/src/render/pass/BorderPassElement.hpp>
 
 #include "SemmetyFrame.hpp"
+#include "SemmetyFrameHypr.hpp"
 #include "SemmetyFrameUtils.hpp"
 #include "SemmetyLayout.hpp"
+#include "SemmetyWindowHypr.hpp"
 #include "SemmetyWorkspaceWrapper.hpp"
 #include "globals.hpp"
 #include "log.hpp"
@@ -34,6 +36,10 @@ CHyprSignalListener focusListener;
 static void renderHook(eRenderStage render_stage) {
 	if (!g_semmetyReady) { return; }
 
+	const SemmetySpan span("renderHook");
+	const SemmetyAllocScope allocs("render", eSemmetyAllocTable::Hook);
+	const SemmetyPerfScope perf("render", eSemmetyPerfTable::Hook);
+
 	static auto PBORDERSIZE = CConfigValue<Hyprlang::INT>("general:border_size");
 	static auto PROUNDING = CConfigValue<Hyprlang::INT>("decoration:rounding");
 	static auto PROUNDINGPOWER = CConfigValue<Hyprlang::FLOAT>("decoration:rounding_power");
@@ -45,12 +51,22 @@ static void renderHook(eRenderStage render_stage) {
 
 	auto layout = g_SemmetyLayout;
 	if (layout == nullptr) { return; }
-	auto ww = layout->getOrCreateWorkspaceWrapper(monitor->m_activeWorkspace);
+	auto& ww = layout->getOrCreateWorkspaceWrapper(monitor->m_activeWorkspace);
 	auto emptyFrames = ww.getRoot()->getEmptyFrames();
+	semmety_trace(
+	    Render,
+	    "stage {} on {}, {} empty frames",
+	    (int) render_stage,
+	    monitor->m_name,
+	    emptyFrames.size()
+	);
 
 	switch (render_stage) {
 	case RENDER_PRE_WINDOWS:
-		for (const auto& frame: emptyFrames) {
+		for (const auto& emptyFrame: emptyFrames) {
+			const auto frame = dynamicPointerCast<SemmetyHyprLeafFrame>(emptyFrame);
+			if (!frame) { continue; }
+
 			CBorderPassElement::SBorderData borderData;
 			borderData.box = frame->getEmptyFrameBox(*monitor);
 			borderData.borderSize = *PBORDERSIZE;
@@ -82,6 +98,10 @@ static void tickHook() {
 	// safe to build animated variables (and thus frames).
 	g_semmetyReady = true;
 
+	const SemmetySpan span("tickHook");
+	const SemmetyAllocScope allocs("tick", eSemmetyAllocTable::Hook);
+	const SemmetyPerfScope perf("tick", eSemmetyPerfTable::Hook);
+
 	auto layout = g_SemmetyLayout;
 	if (layout == nullptr) { return; }
 
@@ -95,6 +115,8 @@ static void tickHook() {
 	// now positions via the layout target, so this just re-asserts the geometry without warping -
 	// it won't disturb an in-progress window-open animation.
 	if (SemmetyLayout::s_reflowPending) {
+		const SemmetySpan reflowSpan("reflow");
+
 		SemmetyLayout::s_reflowPending = false;
 		for (auto& ww: SemmetyLayout::workspaceWrappers) {
 			if (ww.getRoot()) { ww.getRoot()->applyRecursive(ww, std::nullopt, std::nullopt); }
@@ -107,10 +129,14 @@ static void tickHook() {
 		const auto activeWorkspace = monitor->m_activeWorkspace;
 		if (activeWorkspace == nullptr) { continue; }
 
-		const auto ww = layout->getOrCreateWorkspaceWrapper(monitor->m_activeWorkspace);
+		const auto& ww = layout->getOrCreateWorkspaceWrapper(monitor->m_activeWorkspace);
 		auto emptyFrames = ww.getRoot()->getEmptyFrames();
 
-		for (const auto& frame: emptyFrames) { frame->damageEmptyFrameBox(*monitor); }
+		for (const auto& emptyFrame: emptyFrames) {
+			if (auto frame = dynamicPointerCast<SemmetyHyprLeafFrame>(emptyFrame)) {
+				frame->damageEmptyFrameBox(*monitor);
+			}
+		}
 	}
 }
 
@@ -140,7 +166,7 @@ void SemmetyLayout::onEnabled() {
 			continue;
 
 		auto& workspace_wrapper = getOrCreateWorkspaceWrapper(window->m_workspace);
-		workspace_wrapper.addWindow(window);
+		workspace_wrapper.addWindow(toSemmetyWindow(window));
 	}
 
 	renderListener = Event::bus()->m_events.render.stage.listen([](eRenderStage stage) {
@@ -152,20 +178,37 @@ void SemmetyLayout::onEnabled() {
 	});
 
 	workspaceListener = Event::bus()->m_events.workspace.active.listen([](PHLWORKSPACE) {
-		semmety_log(Log::ERR, "WORKSPACE_HOOK");
+		semmety_trace(Layout, "WORKSPACE_HOOK");
 		updateBar();
 	});
 
-	urgentListener = Event::bus()->m_events.window.urgent.listen([](PHLWINDOW) {
+	urgentListener = Event::bus()->m_events.window.urgent.listen([](PHLWINDOW window) {
 		auto layout = g_SemmetyLayout;
 		if (layout == nullptr) { return; }
 
+		// windows that aren't managed yet are picked up by addWindow
+		for (auto& workspace_wrapper: layout->workspaceWrappers) {
+			workspace_wrapper.pruneUrgentWindows();
+			if (workspace_wrapper.workspace == window->m_workspace) {
+				workspace_wrapper.markWindowUrgent(window);
+			}
+		}
+
 		layout->updateBarOnNextTick = true;
 		g_pAnimationManager->scheduleTick();
 	});
 
-	windowTitleListener = Event::bus()->m_events.window.title.listen([](PHLWINDOW) {
-		updateBar();
+	windowTitleListener = Event::bus()->m_events.window.title.listen([](PHLWINDOW window) {
+		// Hyprland refreshes the class together with the title
+		if (auto layout = g_SemmetyLayout) {
+			for (auto& workspace_wrapper: layout->workspaceWrappers) {
+				if (workspace_wrapper.workspace == window->m_workspace) {
+					workspace_wrapper.refreshBarWindow(toSemmetyWindow(window));
+				}
+			}
+		}
+
+		updateBarForTitleChange(window);
 	});
 
 	// Replaces the old IHyprLayout::onWindowFocusChange override (removed in the 0.55 algorithm
@@ -181,10 +224,27 @@ void SemmetyLayout::onEnabled() {
 		    layout->entryWrapper("onWindowFocusChange", [&]() -> std::optional<std::string> {
 			    if (window == nullptr) { return "window is null"; }
 			    if (window->m_workspace == nullptr) { return "window workspace is null"; }
+
+			    SemmetyFlightEntry::note(window->m_workspace->m_id, 0, (uintptr_t) window.get());
+
+			    if (trace.isOpen()) {
+				    trace.write({
+				        .event = SemmetyTraceEvent::Focus,
+				        .workspace = window->m_workspace->m_id,
+				        .window = (uintptr_t) window.get(),
+				        .flag = window->m_isFloating,
+				    });
+			    }
+
+			    // Hyprland clears the urgency of the window it focuses
+			    if (auto* workspace_wrapper = layout->findWorkspaceWrapper(window->m_workspace)) {
+				    workspace_wrapper->pruneUrgentWindows();
+			    }
+
 			    if (window->m_isFloating) { return "window is floating"; }
 
 			    auto& workspace_wrapper = layout->getOrCreateWorkspaceWrapper(window->m_workspace);
-			    workspace_wrapper.activateWindow(window);
+			    workspace_wrapper.activateWindow(toSemmetyWindow(window));
 
 			    shouldUpdateBar();
 
@@ -200,6 +260,8 @@ void SemmetyLayout::onDisabled() {
 	urgentListener.reset();
 	windowTitleListener.reset();
 	focusListener.reset();
+	cancelBarUpdate();
+	stopTrace();
 	s_globalsInitialized = false;
 }
 
@@ -211,6 +273,7 @@ void SemmetyLayout::newTarget(SP<Layout::ITarget> target) {
 		}
 
 		semmety_log(
+		    Layout,
 		    Log::INFO,
 		    "newTarget called with window {:x} (floating: {}, monitor: {}, workspace: {})",
 		    (uintptr_t) window.get(),
@@ -219,6 +282,17 @@ void SemmetyLayout::newTarget(SP<Layout::ITarget> target) {
 		    window->m_workspace->m_id
 		);
 
+		SemmetyFlightEntry::note(window->m_workspace->m_id, 0, (uintptr_t) window.get());
+
+		if (trace.isOpen()) {
+			trace.write({
+			    .event = SemmetyTraceEvent::NewTarget,
+			    .workspace = window->m_workspace->m_id,
+			    .window = (uintptr_t) window.get(),
+			    .flag = window->m_isFloating,
+			});
+		}
+
 		if (window->m_isFloating) { return "window is floating"; }
 
 		auto& workspace_wrapper = getOrCreateWorkspaceWrapper(window->m_workspace);
@@ -226,11 +300,12 @@ void SemmetyLayout::newTarget(SP<Layout::ITarget> target) {
 		// addWindow() is not idempotent (it unconditionally appends), so guard against re-adding a
 		// window that is already tracked. movedTarget() routes here, and may fire for a target that
 		// is already part of this space.
-		if (workspace_wrapper.findWindowIt(window) != workspace_wrapper.windows.end()) {
+		const auto handle = toSemmetyWindow(window);
+		if (workspace_wrapper.findWindowIt(handle) != workspace_wrapper.windows.end()) {
 			return "window already tracked in workspace";
 		}
 
-		workspace_wrapper.addWindow(window);
+		workspace_wrapper.addWindow(handle);
 
 		// Re-apply layout on the next tick: the window isn't mapped yet here (so applyRecursive
 		// can't size it), and Hyprland will reset it to the engine box once it maps.
@@ -253,6 +328,7 @@ void SemmetyLayout::removeTarget(SP<Layout::ITarget> target) {
 		if (window->m_workspace == nullptr) { return "workspace is null"; }
 
 		semmety_log(
+		    Layout,
 		    Log::INFO,
 		    "removeTarget window {:x} (floating: {}, monitor: {}, workspace: {}, title: {})",
 		    (uintptr_t) window.get(),
@@ -262,11 +338,21 @@ void SemmetyLayout::removeTarget(SP<Layout::ITarget> target) {
 		    window->fetchTitle()
 		);
 
+		SemmetyFlightEntry::note(window->m_workspace->m_id, 0, (uintptr_t) window.get());
+
+		if (trace.isOpen()) {
+			trace.write({
+			    .event = SemmetyTraceEvent::RemoveTarget,
+			    .workspace = window->m_workspace->m_id,
+			    .window = (uintptr_t) window.get(),
+			});
+		}
+
 		window->updateWindowData();
 		if (window->isFullscreen()) { g_pCompositor->setWindowFullscreenInternal(window, FSMODE_NONE); }
 
 		auto& workspace_wrapper = getOrCreateWorkspaceWrapper(window->m_workspace);
-		workspace_wrapper.removeWindow(window);
+		workspace_wrapper.removeWindow(toSemmetyWindow(window));
 
 		shouldUpdateBar();
 		g_pAnimationManager->scheduleTick();
@@ -282,10 +368,12 @@ void SemmetyLayout::recalculateWorkspace(const PHLWORKSPACE& workspace) {
 		const auto monitor = workspace->m_monitor;
 		if (!monitor) { return "monitor is null"; }
 
+		SemmetyFlightEntry::note(workspace->m_id, 0, 0);
+
 		auto& ww = getOrCreateWorkspaceWrapper(workspace);
 
 		// Mirror the pre-0.55 geometry: monitor box minus reserved area. (Per-window gaps are still
-		// applied separately via SemmetyLeafFrame::getStandardWindowArea, so gaps_out is not removed
+		// applied separately via getStandardWindowArea, so gaps_out is not removed
 		// here, matching the original behaviour and the workspace-wrapper constructor.)
 		auto reserved = monitor->m_reservedArea;
 		auto pos = monitor->m_position + Vector2D(reserved.left(), reserved.top());
@@ -308,6 +396,8 @@ void SemmetyLayout::recalculate(Layout::eRecalculateReason) {
 		auto workspace = space->workspace();
 		if (!workspace) { return "no workspace"; }
 
+		SemmetyFlightEntry::note(workspace->m_id, 0, 0);
+
 		// Only lay out a workspace we are already managing. Don't lazily build the frame tree here:
 		// recalculate() can fire very early (e.g. during CMonitor::onConnect in unsafe state) before
 		// the config/animation subsystems are ready to construct a frame, and the built-in algorithms
@@ -324,6 +414,15 @@ void SemmetyLayout::recalculate(Layout::eRecalculateReason) {
 
 		recalculateWorkspace(workspace);
 
+		if (trace.isOpen()) {
+			trace.write({
+			    .event = SemmetyTraceEvent::Recalculate,
+			    .workspace = workspace->m_id,
+			    .flag = !workspace->m_hasFullscreenWindow,
+			    .box = ww->getRoot()->geometry,
+			});
+		}
+
 		// In the 0.55 algorithm API recalculate() is the single entry point for (re)positioning
 		// tiled windows (it replaces IHyprLayout::recalculateMonitor), so reflow the frame tree
 		// after updating the root geometry. A fullscreen window is positioned by the engine, so
@@ -336,6 +435,18 @@ void SemmetyLayout::recalculate(Layout::eRecalculateReason) {
 	});
 }
 
+static ResizeCorner toResizeCorner(Layout::eRectCorner corner) {
+	switch (corner) {
+	case Layout::CORNER_TOPLEFT: return ResizeCorner::TopLeft;
+	case Layout::CORNER_TOPRIGHT: return ResizeCorner::TopRight;
+	case Layout::CORNER_BOTTOMRIGHT: return ResizeCorner::BottomRight;
+	case Layout::CORNER_BOTTOMLEFT: return ResizeCorner::BottomLeft;
+	case Layout::CORNER_NONE: return ResizeCorner::None;
+	}
+
+	return ResizeCorner::None;
+}
+
 void SemmetyLayout::resizeTarget(
     const Vector2D& delta,
     SP<Layout::ITarget> target,
@@ -349,63 +460,20 @@ void SemmetyLayout::resizeTarget(
 	auto workspace = workspace_for_window(window);
 	if (!workspace) { return; }
 
-	auto frame = workspace->getFrameForWindow(window);
+	auto frame = workspace->getFrameForWindow(toSemmetyWindow(window));
 	if (!frame) { return; }
 
-	auto resizeDelta = delta;
-	SP<SemmetySplitFrame> horizontalParent, verticalParent;
-
-	switch (corner) {
-	case Layout::CORNER_TOPLEFT:
-		horizontalParent = getResizeTarget(*workspace, frame, Direction::Left);
-		verticalParent = getResizeTarget(*workspace, frame, Direction::Up);
-		resizeDelta.x *= -1;
-		resizeDelta.y *= -1;
-		break;
-	case Layout::CORNER_TOPRIGHT:
-		horizontalParent = getResizeTarget(*workspace, frame, Direction::Right);
-		verticalParent = getResizeTarget(*workspace, frame, Direction::Up);
-		resizeDelta.y *= -1;
-		break;
-	case Layout::CORNER_BOTTOMRIGHT:
-		horizontalParent = getResizeTarget(*workspace, frame, Direction::Right);
-		verticalParent = getResizeTarget(*workspace, frame, Direction::Down);
-		break;
-	case Layout::CORNER_BOTTOMLEFT:
-		horizontalParent = getResizeTarget(*workspace, frame, Direction::Left);
-		verticalParent = getResizeTarget(*workspace, frame, Direction::Down);
-		resizeDelta.x *= -1;
-		break;
-	case Layout::CORNER_NONE:
-		horizontalParent = getResizeTarget(*workspace, frame, Direction::Left, Direction::Right);
-		verticalParent = getResizeTarget(*workspace, frame, Direction::Up, Direction::Down);
-		break;
+	if (trace.isOpen()) {
+		trace.write({
+		    .event = SemmetyTraceEvent::ResizeTarget,
+		    .workspace = window->m_workspace->m_id,
+		    .window = (uintptr_t) window.get(),
+		    .delta = delta,
+		    .corner = toResizeCorner(corner),
+		});
 	}
 
-	if (!horizontalParent && !verticalParent) { return; }
-
-	if (horizontalParent) {
-		if (horizontalParent->getChildren().second->isSameOrDescendant(frame)) { resizeDelta.x *= -1; }
-
-		horizontalParent->resize(resizeDelta.x);
-	}
-
-	if (verticalParent) {
-		if (verticalParent->getChildren().second->isSameOrDescendant(frame)) { resizeDelta.y *= -1; }
-
-		verticalParent->resize(resizeDelta.y);
-	}
-
-	SP<SemmetyFrame> commonParent;
-	if (!horizontalParent) {
-		commonParent = verticalParent;
-	} else if (!verticalParent) {
-		commonParent = horizontalParent;
-	} else {
-		commonParent = getCommonParent(*workspace, horizontalParent, verticalParent);
-	}
-
-	commonParent->applyRecursive(*workspace, std::nullopt, true);
+	resizeFrame(*workspace, frame, delta, toResizeCorner(corner));
 }
 
 Layout::eFullscreenRequestResult SemmetyLayout::requestFullscreen(const Layout::SFullscreenRequest& request) {
@@ -418,10 +486,18 @@ Layout::eFullscreenRequestResult SemmetyLayout::requestFullscreen(const Layout::
 		auto workspace = workspace_for_window(window);
 		if (!workspace) { return "Failed to get workspace for window"; }
 
-		semmety_log(Log::ERR, "current: {}, effective: {}", CURRENT_EFFECTIVE_MODE, EFFECTIVE_MODE);
+		SemmetyFlightEntry::note(window->m_workspace->m_id, 0, (uintptr_t) window.get());
+
+		semmety_log(
+		    Layout,
+		    Log::INFO,
+		    "current: {}, effective: {}",
+		    CURRENT_EFFECTIVE_MODE,
+		    EFFECTIVE_MODE
+		);
 
 		if (EFFECTIVE_MODE == FSMODE_NONE) {
-			auto frame = workspace->getFrameForWindow(window);
+			auto frame = workspace->getFrameForWindow(toSemmetyWindow(window));
 			if (frame) {
 				frame->applyRecursive(*workspace, std::nullopt, false);
 			} else {
@@ -455,16 +531,16 @@ Layout::eFullscreenRequestResult SemmetyLayout::requestFullscreen(const Layout::
 }
 
 Config::ErrorResult SemmetyLayout::layoutMsg(const std::string_view& sv) {
-	semmety_log(Log::INFO, "STUB layoutMsg");
+	semmety_log(Layout, Log::INFO, "STUB layoutMsg");
 	return {};
 }
 
 void SemmetyLayout::swapTargets(SP<Layout::ITarget>, SP<Layout::ITarget>) {
-	semmety_log(Log::INFO, "STUB swapTargets");
+	semmety_log(Layout, Log::INFO, "STUB swapTargets");
 }
 
 void SemmetyLayout::moveTargetInDirection(SP<Layout::ITarget>, Math::eDirection, bool) {
-	semmety_log(Log::INFO, "STUB moveTargetInDirection");
+	semmety_log(Layout, Log::INFO, "STUB moveTargetInDirection");
 }
 
 std::optional<Vector2D> SemmetyLayout::predictSizeForNewTarget() {
@@ -473,6 +549,12 @@ std::optional<Vector2D> SemmetyLayout::predictSizeForNewTarget() {
 
 		if (!ws) { return std::nullopt; }
 
+		SemmetyFlightEntry::note(
+		    ws->workspace ? ws->workspace->m_id : 0,
+		    (uintptr_t) ws->getFocusedFrame().get(),
+		    0
+		);
+
 		return ws->getFocusedFrame()->geometry.size();
 	});
 }
@@ -502,7 +584,7 @@ SP<Layout::ITarget> SemmetyLayout::getNextCandidate(SP<Layout::ITarget> old) {
 	const auto index = ws->getLastFocusedWindowIndex();
 	if (index >= ws->windows.size()) { return {}; }
 
-	auto candidateWindow = ws->windows[index].lock();
+	auto candidateWindow = toHyprWindow(ws->windows[index]).lock();
 	if (!candidateWindow) { return {}; }
 
 	auto space = old->space();
@@ -0,0 +1,179 @@
+#include "SemmetyPerfCounters.hpp"
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <fstream>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using Hyprutils::OS::CFileDescriptor;
+
+static const char* counterNames[] = {"cycles", "instructions", "cacheMisses", "branchMisses"};
+
+static const uint64_t counterConfigs[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+static uint32_t currentThread() {
+	static thread_local const uint32_t thread = gettid();
+	return thread;
+}
+
+static int openCounter(uint64_t config, int group) {
+	perf_event_attr attr {};
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = config;
+	// user space only, so kernel.perf_event_paranoid up to 2 still allows it
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format =
+	    PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return syscall(SYS_perf_event_open, &attr, 0, -1, group, PERF_FLAG_FD_CLOEXEC);
+}
+
+static std::string openError(int error) {
+	std::string paranoid = "unknown";
+	std::ifstream("/proc/sys/kernel/perf_event_paranoid") >> paranoid;
+
+	return std::format(
+	    "perf_event_open failed: {} (kernel.perf_event_paranoid is {})",
+	    strerror(error),
+	    paranoid
+	);
+}
+
+void SemmetyPerfCounters::start() {
+	std::lock_guard lock(m_mutex);
+	if (m_started) { return; }
+	m_started = true;
+
+	int leaderError = 0;
+
+	for (size_t i = 0; i < COUNTER_COUNT; i++) {
+		const auto group = m_leader.isValid() ? m_leader.get() : -1;
+		CFileDescriptor fd {openCounter(counterConfigs[i], group)};
+
+		if (!fd.isValid()) {
+			if (!m_leader.isValid()) { leaderError = errno; }
+			continue;
+		}
+
+		m_groupIndex[i] = m_groupSize++;
+		if (!m_leader.isValid()) {
+			m_leader = std::move(fd);
+		} else {
+			m_members[i] = std::move(fd);
+		}
+	}
+
+	if (!m_leader.isValid()) {
+		m_error = openError(leaderError);
+		return;
+	}
+
+	m_error.clear();
+	m_thread = currentThread();
+	m_active.store(true, std::memory_order_relaxed);
+}
+
+void SemmetyPerfCounters::stop() {
+	m_active.store(false, std::memory_order_relaxed);
+
+	std::lock_guard lock(m_mutex);
+	m_leader.reset();
+	for (auto& member: m_members) { member.reset(); }
+	m_error = "stopped";
+}
+
+bool SemmetyPerfCounters::active() const {
+	return m_active.load(std::memory_order_relaxed) && currentThread() == (uint32_t) m_thread;
+}
+
+std::optional<SemmetyPerfCounters::SReading> SemmetyPerfCounters::read() const {
+	// nr, time enabled, time running, then one value per counter in the group
+	std::array<uint64_t, 3 + COUNTER_COUNT> buffer {};
+	const auto size = (3 + m_groupSize) * sizeof(uint64_t);
+	if (::read(m_leader.get(), buffer.data(), size) != (ssize_t) size) { return std::nullopt; }
+
+	SReading reading {.enabled = buffer[1], .running = buffer[2]};
+	for (size_t i = 0; i < COUNTER_COUNT; i++) {
+		if (m_groupIndex[i] >= 0) { reading.counts[i] = buffer[3 + m_groupIndex[i]]; }
+	}
+
+	return reading;
+}
+
+SemmetyPerfCounters::Sample
+SemmetyPerfCounters::delta(const SReading& start, const SReading& end) {
+	// Scaling each reading by its own ratio and subtracting could go negative. The raw counts only
+	// grow, so scale their difference by the ratio over the same interval instead.
+	const auto enabled = end.enabled - start.enabled;
+	const auto running = end.running - start.running;
+
+	Sample delta {};
+	for (size_t i = 0; i < COUNTER_COUNT; i++) {
+		delta[i] = end.counts[i] - start.counts[i];
+		if (running > 0 && running < enabled) {
+			delta[i] = (uint64_t) ((double) delta[i] * (double) enabled / (double) running);
+		}
+	}
+
+	return delta;
+}
+
+void SemmetyPerfCounters::record(
+    eSemmetyPerfTable table,
+    std::string_view name,
+    const Sample& delta
+) {
+	std::lock_guard lock(m_mutex);
+
+	auto& entries = table == eSemmetyPerfTable::Hook ? m_hooks : m_entryPoints;
+	auto it = entries.find(name);
+	if (it == entries.end()) { it = entries.emplace(name, SEntry {}).first; }
+
+	auto& entry = it->second;
+	entry.count += 1;
+	for (size_t i = 0; i < COUNTER_COUNT; i++) { entry.totals[i] += delta[i]; }
+}
+
+void SemmetyPerfCounters::reset() {
+	std::lock_guard lock(m_mutex);
+	m_entryPoints.clear();
+	m_hooks.clear();
+}
+
+json SemmetyPerfCounters::toJson() const {
+	std::lock_guard lock(m_mutex);
+
+	const auto entriesJson = [&](const Entries& entries) {
+		json out = json::object();
+		for (const auto& [name, entry]: entries) {
+			auto& counters = out[name];
+			counters["count"] = entry.count;
+			for (size_t i = 0; i < COUNTER_COUNT; i++) {
+				if (m_groupIndex[i] >= 0) { counters[counterNames[i]] = entry.totals[i]; }
+			}
+		}
+
+		return out;
+	};
+
+	json opened = json::object();
+	for (size_t i = 0; i < COUNTER_COUNT; i++) { opened[counterNames[i]] = m_groupIndex[i] >= 0; }
+
+	return {
+	    {"enabled", m_error.empty()},
+	    {"error", m_error},
+	    {"counters", std::move(opened)},
+	    {"entryPoints", entriesJson(m_entryPoints)},
+	    {"hooks", entriesJson(m_hooks)},
+	};
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <hyprutils/os/FileDescriptor.hpp>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+enum class eSemmetyPerfTable {
+	EntryPoint,
+	Hook,
+};
+
+// Hardware counters of the compositor thread, read around each entryWrapper() entry point and the
+// render and tick hooks, opened with perf_event_open when plugin:semmety:perf_counters is set.
+// Counters the kernel or the machine refuses are left out, and if none open at all the reason is
+// kept for the socket's perf reply and the scopes do nothing.
+class SemmetyPerfCounters {
+public:
+	enum eCounter {
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES,
+		BRANCH_MISSES,
+		COUNTER_COUNT,
+	};
+
+	using Sample = std::array<uint64_t, COUNTER_COUNT>;
+
+	// Raw counts and how long the group was enabled and actually counting, in ns.
+	struct SReading {
+		Sample counts {};
+		uint64_t enabled = 0;
+		uint64_t running = 0;
+	};
+
+	// Opens the counters for the calling thread, only the first call has an effect.
+	void start();
+	void stop();
+	// Whether the counters are open and belong to the calling thread.
+	bool active() const;
+	// The counters so far. Counters that didn't open read 0.
+	std::optional<SReading> read() const;
+	// What was counted between two readings, scaled up by how much of that time the counters were
+	// running if the kernel had to multiplex them.
+	static Sample delta(const SReading& start, const SReading& end);
+
+	void record(eSemmetyPerfTable table, std::string_view name, const Sample& delta);
+	void reset();
+	// {"enabled", "error", "counters": {name: opened}, "entryPoints": {...}, "hooks": {...}} with
+	// {"count", "cycles", "instructions", "cacheMisses", "branchMisses"} totals per name.
+	json toJson() const;
+
+private:
+	struct SEntry {
+		uint64_t count = 0;
+		Sample totals {};
+	};
+
+	struct SNameHash {
+		using is_transparent = void;
+		size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+	};
+
+	using Entries = std::unordered_map<std::string, SEntry, SNameHash, std::equal_to<>>;
+
+	// the group leader is the first counter that opened, reads return every counter in the group
+	Hyprutils::OS::CFileDescriptor m_leader;
+	std::array<Hyprutils::OS::CFileDescriptor, COUNTER_COUNT> m_members;
+	// where each counter is in a group read, -1 if it didn't open
+	std::array<int, COUNTER_COUNT> m_groupIndex {-1, -1, -1, -1};
+	size_t m_groupSize = 0;
+	int m_thread = 0;
+	std::atomic<bool> m_active = false;
+
+	mutable std::mutex m_mutex;
+	bool m_started = false;
+	std::string m_error = "off, set plugin:semmety:perf_counters";
+	Entries m_entryPoints;
+	Entries m_hooks;
+};
+
+inline SemmetyPerfCounters g_semmetyPerf;
+
+// Records the counter deltas of the scope when the counters are active on this thread.
+class SemmetyPerfScope {
+public:
+	SemmetyPerfScope(std::string_view name, eSemmetyPerfTable table):
+	    m_name(name), m_table(table) {
+		if (g_semmetyPerf.active()) { m_start = g_semmetyPerf.read(); }
+	}
+
+	~SemmetyPerfScope() {
+		if (!m_start) { return; }
+
+		const auto end = g_semmetyPerf.read();
+		if (!end) { return; }
+
+		g_semmetyPerf.record(m_table, m_name, SemmetyPerfCounters::delta(*m_start, *end));
+	}
+
+	SemmetyPerfScope(const SemmetyPerfScope&) = delete;
+	SemmetyPerfScope& operator=(const SemmetyPerfScope&) = delete;
+
+private:
+	std::string_view m_name;
+	eSemmetyPerfTable m_table;
+	std::optional<SemmetyPerfCounters::SReading> m_start;
+};
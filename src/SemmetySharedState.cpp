@@ -0,0 +1,132 @@
+#include "SemmetySharedState.hpp"
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace Hyprutils::OS;
+
+SemmetySharedState::SemmetySharedState(size_t size) {
+	// round up to whole pages, the mapping covers them anyway
+	const auto PAGE = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	size = std::max(size, sizeof(SemmetySharedHeader));
+	size = (size + PAGE - 1) / PAGE * PAGE;
+
+	CFileDescriptor fd {memfd_create("semmety-state", MFD_CLOEXEC | MFD_ALLOW_SEALING)};
+	if (!fd.isValid() || ftruncate(fd.get(), static_cast<off_t>(size)) < 0) { return; }
+
+	// Clients must not be able to resize the region under us (SIGBUS) or map it writable. The write
+	// seal is added after mapping, it only prevents new writable mappings.
+	fcntl(fd.get(), F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW);
+
+	auto* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+	if (mapping == MAP_FAILED) { return; }
+
+#ifdef F_SEAL_FUTURE_WRITE
+	fcntl(fd.get(), F_ADD_SEALS, F_SEAL_FUTURE_WRITE);
+#endif
+
+	m_pFD = makeShared<CFileDescriptor>(std::move(fd));
+	m_iSize = size;
+
+	// a fresh memfd is zero filled, so only the constant fields need setting
+	m_pHeader = new (mapping) SemmetySharedHeader {};
+	m_pHeader->magic = SEMMETY_SHARED_MAGIC;
+	m_pHeader->version = SEMMETY_SHARED_VERSION;
+	m_pHeader->size = static_cast<uint32_t>(size);
+	m_pHeader->windowsOffset = sizeof(SemmetySharedHeader);
+	m_pHeader->workspacesOffset = sizeof(SemmetySharedHeader);
+	m_pHeader->stringsOffset = sizeof(SemmetySharedHeader);
+}
+
+SemmetySharedState::~SemmetySharedState() {
+	if (m_pHeader != nullptr) { munmap(m_pHeader, m_iSize); }
+}
+
+size_t SemmetySharedState::requiredSize(const SemmetyBarState& state) {
+	size_t size = sizeof(SemmetySharedHeader);
+	size += state.windows.size() * sizeof(SemmetySharedWindow);
+	size += state.workspaces.size() * sizeof(SemmetySharedWorkspace);
+
+	for (const auto& window: state.windows) {
+		size += window->address.size() + window->title.size() + window->appid.size();
+	}
+
+	for (const auto& workspace: state.workspaces) {
+		size += workspace.name.size() + workspace.monitor.size();
+	}
+
+	return size;
+}
+
+bool SemmetySharedState::write(const SemmetyBarState& state, uint64_t barSeq) {
+	if (!valid() || requiredSize(state) > m_iSize) { return false; }
+
+	auto* base = reinterpret_cast<char*>(m_pHeader);
+
+	const auto windowsOffset = sizeof(SemmetySharedHeader);
+	const auto workspacesOffset =
+	    windowsOffset + state.windows.size() * sizeof(SemmetySharedWindow);
+	const auto stringsOffset =
+	    workspacesOffset + state.workspaces.size() * sizeof(SemmetySharedWorkspace);
+
+	auto* strings = base + stringsOffset;
+	uint32_t stringsLength = 0;
+	const auto addString = [&](const std::string& str) {
+		std::memcpy(strings + stringsLength, str.data(), str.size());
+
+		const SemmetySharedString range {stringsLength, static_cast<uint32_t>(str.size())};
+		stringsLength += str.size();
+		return range;
+	};
+
+	const auto SEQUENCE = m_pHeader->sequence.load(std::memory_order_relaxed);
+	m_pHeader->sequence.store(SEQUENCE + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	auto* windows = reinterpret_cast<SemmetySharedWindow*>(base + windowsOffset);
+	for (const auto& window: state.windows) {
+		*windows++ = {
+		    .address = addString(window->address),
+		    .title = addString(window->title),
+		    .appid = addString(window->appid),
+		    .flags = (window->urgent ? SHARED_WINDOW_URGENT : 0u)
+		           | (window->focused ? SHARED_WINDOW_FOCUSED : 0u)
+		           | (window->minimized ? SHARED_WINDOW_MINIMIZED : 0u),
+		};
+	}
+
+	auto* workspaces = reinterpret_cast<SemmetySharedWorkspace*>(base + workspacesOffset);
+	for (const auto& workspace: state.workspaces) {
+		*workspaces++ = {
+		    .id = workspace.id,
+		    .numWindows = static_cast<uint32_t>(workspace.numWindows),
+		    .name = addString(workspace.name),
+		    .monitor = addString(workspace.monitor),
+		    .flags = (workspace.focused ? SHARED_WORKSPACE_FOCUSED : 0u)
+		           | (workspace.urgent ? SHARED_WORKSPACE_URGENT : 0u)
+		           | (workspace.visible ? SHARED_WORKSPACE_VISIBLE : 0u),
+		};
+	}
+
+	m_pHeader->barSeq = barSeq;
+	m_pHeader->numWindows = state.windows.size();
+	m_pHeader->numWorkspaces = state.workspaces.size();
+	m_pHeader->windowsOffset = windowsOffset;
+	m_pHeader->workspacesOffset = workspacesOffset;
+	m_pHeader->stringsOffset = stringsOffset;
+	m_pHeader->stringsLength = stringsLength;
+
+	m_pHeader->sequence.store(SEQUENCE + 2, std::memory_order_release);
+	return true;
+}
+
+void SemmetySharedState::markReplaced() {
+	if (!valid()) { return; }
+
+	m_pHeader->flags.fetch_or(SHARED_REPLACED, std::memory_order_release);
+	// readers spinning on an unchanged sequence should notice too
+	m_pHeader->sequence.fetch_add(2, std::memory_order_release);
+}
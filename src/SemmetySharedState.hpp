@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/os/FileDescriptor.hpp>
+
+#include "SemmetyBarState.hpp"
+
+// The latest bar state, published into a memfd that clients map read-only after receiving its fd
+// over the socket (see "mode shm"). Readers find everything at fixed offsets and never need a
+// syscall or a parser to look at the current state.
+//
+// Layout: a SemmetySharedHeader at offset 0, followed by the window records, the workspace records
+// and the string bytes at the offsets the header gives. Strings are not NUL terminated.
+//
+// The header sequence is a seqlock. It is odd while the writer is updating the region. A reader
+// loads it (acquire), retries while it is odd, copies what it needs, issues an acquire fence and
+// loads it again. The copy is only consistent if both loads match.
+//
+// When the state outgrows the region a larger one is created and sent to the clients, and
+// SHARED_REPLACED is set in the old header. Readers should then switch to the new fd.
+
+constexpr uint32_t SEMMETY_SHARED_MAGIC = 0x594d4d53; // "SMMY"
+constexpr uint32_t SEMMETY_SHARED_VERSION = 2;
+
+enum eSemmetySharedFlags : uint32_t {
+	SHARED_REPLACED = 1 << 0,
+};
+
+enum eSemmetySharedWindowFlags : uint32_t {
+	SHARED_WINDOW_URGENT = 1 << 0,
+	SHARED_WINDOW_FOCUSED = 1 << 1,
+	SHARED_WINDOW_MINIMIZED = 1 << 2,
+};
+
+enum eSemmetySharedWorkspaceFlags : uint32_t {
+	SHARED_WORKSPACE_FOCUSED = 1 << 0,
+	SHARED_WORKSPACE_URGENT = 1 << 1,
+	SHARED_WORKSPACE_VISIBLE = 1 << 2,
+};
+
+// Range in the string bytes.
+struct SemmetySharedString {
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct SemmetySharedWindow {
+	SemmetySharedString address;
+	SemmetySharedString title;
+	SemmetySharedString appid;
+	uint32_t flags;
+};
+
+struct SemmetySharedWorkspace {
+	int32_t id;
+	uint32_t numWindows;
+	SemmetySharedString name;
+	SemmetySharedString monitor;
+	uint32_t flags;
+};
+
+struct SemmetySharedHeader {
+	uint32_t magic;
+	uint32_t version;
+	std::atomic<uint64_t> sequence;
+	uint64_t barSeq; // seq of the bar update this state belongs to
+	uint32_t size;   // size of the whole region
+	std::atomic<uint32_t> flags;
+	uint32_t numWindows;
+	uint32_t numWorkspaces;
+	uint32_t windowsOffset;
+	uint32_t workspacesOffset;
+	uint32_t stringsOffset;
+	uint32_t stringsLength;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+class SemmetySharedState {
+public:
+	// Creates and maps a region of at least `size` bytes. Check valid() afterwards.
+	explicit SemmetySharedState(size_t size);
+	~SemmetySharedState();
+
+	SemmetySharedState(const SemmetySharedState&) = delete;
+	SemmetySharedState& operator=(const SemmetySharedState&) = delete;
+
+	bool valid() const { return m_pHeader != nullptr; }
+	size_t size() const { return m_iSize; }
+
+	// Shared so queued messages can keep it open until it has been sent.
+	const SP<Hyprutils::OS::CFileDescriptor>& fd() const { return m_pFD; }
+
+	// Bytes needed to hold `state`.
+	static size_t requiredSize(const SemmetyBarState& state);
+
+	// Publishes the windows and workspaces of `state`. Returns false, leaving the region untouched,
+	// if it does not fit.
+	bool write(const SemmetyBarState& state, uint64_t barSeq);
+
+	void markReplaced();
+
+private:
+	SP<Hyprutils::OS::CFileDescriptor> m_pFD;
+	SemmetySharedHeader* m_pHeader = nullptr;
+	size_t m_iSize = 0;
+};
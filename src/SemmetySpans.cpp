@@ -0,0 +1,111 @@
+#include "SemmetySpans.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+static uint32_t currentThread() {
+	static thread_local const uint32_t thread = gettid();
+	return thread;
+}
+
+void SemmetySpanRecorder::start(size_t capacity) {
+	if (m_slots || capacity == 0) { return; }
+
+	m_slots = std::make_unique<SSlot[]>(capacity);
+	m_capacity = capacity;
+	m_enabled.store(true, std::memory_order_release);
+}
+
+void SemmetySpanRecorder::record(
+    std::string_view name,
+    uint64_t start,
+    uint64_t end,
+    uint32_t depth
+) {
+	const auto index = m_next.fetch_add(1, std::memory_order_relaxed);
+	auto& slot = m_slots[index % m_capacity];
+
+	// a seqlock per slot, dump() skips the slot while the odd value is in it
+	slot.seq.store(index * 2 + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.start = start;
+	slot.end = end;
+	slot.thread = currentThread();
+	slot.depth = depth;
+
+	const auto length = std::min(name.size(), sizeof(slot.name) - 1);
+	std::memcpy(slot.name, name.data(), length);
+	slot.name[length] = '\0';
+
+	slot.seq.store(index * 2 + 2, std::memory_order_release);
+}
+
+void SemmetySpanRecorder::nameThread(std::string name) {
+	std::lock_guard lock(m_threadNamesMutex);
+	m_threadNames[currentThread()] = std::move(name);
+}
+
+bool SemmetySpanRecorder::dump(const std::string& path) const {
+	if (!m_slots) { return false; }
+
+	const auto pid = getpid();
+	json events = json::array();
+
+	{
+		std::lock_guard lock(m_threadNamesMutex);
+		for (const auto& [thread, name]: m_threadNames) {
+			events.push_back({
+			    {"name", "thread_name"},
+			    {"ph", "M"},
+			    {"pid", pid},
+			    {"tid", thread},
+			    {"args", {{"name", name}}},
+			});
+		}
+	}
+
+	const auto next = m_next.load(std::memory_order_acquire);
+	const auto first = next > m_capacity ? next - m_capacity : 0;
+
+	for (auto index = first; index < next; index++) {
+		const auto& slot = m_slots[index % m_capacity];
+
+		const auto seq = slot.seq.load(std::memory_order_acquire);
+		if (seq != index * 2 + 2) { continue; }
+
+		const auto start = slot.start;
+		const auto end = slot.end;
+		const auto thread = slot.thread;
+		const auto depth = slot.depth;
+		char name[sizeof(slot.name)];
+		std::memcpy(name, slot.name, sizeof(name));
+		name[sizeof(name) - 1] = '\0';
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.seq.load(std::memory_order_relaxed) != seq) { continue; }
+
+		// complete events, timestamps in microseconds
+		events.push_back({
+		    {"name", name},
+		    {"ph", "X"},
+		    {"ts", start / 1000.0},
+		    {"dur", (end - start) / 1000.0},
+		    {"pid", pid},
+		    {"tid", thread},
+		    {"args", {{"depth", depth}}},
+		});
+	}
+
+	std::ofstream file(path, std::ios::trunc);
+	if (!file) { return false; }
+
+	const json trace = {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ns"}};
+	file << trace.dump(-1, ' ', false, json::error_handler_t::replace);
+	return file.good();
+}
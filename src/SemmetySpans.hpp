@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "SemmetyClock.hpp"
+
+// Timed spans of semmety's own work, kept in a ring and written out as Chrome trace-event JSON for
+// Perfetto or chrome://tracing. Recording is off until start(). Any thread may record, a span costs
+// two clock reads and one slot write, and once the ring is full the newest spans overwrite the
+// oldest.
+class SemmetySpanRecorder {
+public:
+	// Allocates room for `capacity` spans and starts recording. Only the first call has an effect,
+	// the ring stays allocated so threads that are recording never see it go away.
+	void start(size_t capacity);
+	bool enabled() const { return m_enabled.load(std::memory_order_acquire); }
+	// `start` and `end` are semmetyMonotonicNs() times, names longer than a slot are cut short.
+	void record(std::string_view name, uint64_t start, uint64_t end, uint32_t depth);
+	// Shown as the thread's name in the trace.
+	void nameThread(std::string name);
+	// Writes the recorded spans, oldest first. Spans that are being overwritten are skipped.
+	bool dump(const std::string& path) const;
+
+private:
+	struct SSlot {
+		// 2 * index + 2 once span `index` is complete, odd while it is being written
+		std::atomic<uint64_t> seq = 0;
+		uint64_t start = 0;
+		uint64_t end = 0;
+		uint32_t thread = 0;
+		uint32_t depth = 0;
+		char name[40] = {};
+	};
+
+	std::unique_ptr<SSlot[]> m_slots;
+	size_t m_capacity = 0;
+	std::atomic<uint64_t> m_next = 0;
+	std::atomic<bool> m_enabled = false;
+
+	mutable std::mutex m_threadNamesMutex;
+	std::unordered_map<uint32_t, std::string> m_threadNames;
+};
+
+inline SemmetySpanRecorder g_semmetySpans;
+
+// Records the scope as a span when recording is on. Spans nest per thread, on the compositor thread
+// the depth of an entry point span is its entryCount.
+class SemmetySpan {
+public:
+	explicit SemmetySpan(std::string_view name) {
+		if (!g_semmetySpans.enabled()) { return; }
+
+		m_name = name;
+		m_depth = t_depth++;
+		m_start = semmetyMonotonicNs();
+	}
+
+	~SemmetySpan() {
+		if (m_start == 0) { return; }
+
+		g_semmetySpans.record(m_name, m_start, semmetyMonotonicNs(), m_depth);
+		t_depth -= 1;
+	}
+
+	SemmetySpan(const SemmetySpan&) = delete;
+	SemmetySpan& operator=(const SemmetySpan&) = delete;
+
+private:
+	std::string_view m_name;
+	uint64_t m_start = 0;
+	uint32_t m_depth = 0;
+
+	inline static thread_local uint32_t t_depth = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+template <typename T, size_t Capacity>
+class SemmetySpscQueue {
+	static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+	// Producer only. Returns false, leaving `value` untouched, if the queue is full.
+	bool push(T&& value) {
+		const auto tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == Capacity) { return false; }
+
+		m_slots[tail % Capacity] = std::move(value);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.
+	std::optional<T> pop() {
+		const auto head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) { return std::nullopt; }
+
+		std::optional<T> value = std::move(m_slots[head % Capacity]);
+		m_head.store(head + 1, std::memory_order_release);
+		return value;
+	}
+
+private:
+	std::array<T, Capacity> m_slots;
+	// on separate cache lines so the two threads don't contend on them
+	alignas(64) std::atomic<size_t> m_head = 0;
+	alignas(64) std::atomic<size_t> m_tail = 0;
+};
@@ -0,0 +1,70 @@
+#include "SemmetyStandIn.hpp"
+#include <format>
+
+#include <hyprutils/memory/SharedPtr.hpp>
+
+using namespace Hyprutils::Math;
+
+//
+// SemmetyStandInWindow
+//
+
+SemmetyStandInWindow::SemmetyStandInWindow(uint64_t id, bool floating):
+    floating(floating), m_id(id) {}
+
+SP<SemmetyStandInWindow> SemmetyStandInWindow::create(uint64_t id, bool floating) {
+	return makeShared<SemmetyStandInWindow>(id, floating);
+}
+
+bool SemmetyStandInWindow::isFloating() const { return floating; }
+
+bool SemmetyStandInWindow::isHidden() const { return hidden; }
+
+void SemmetyStandInWindow::setHidden(bool hidden) { this->hidden = hidden; }
+
+bool SemmetyStandInWindow::isMapped() const { return mapped; }
+
+std::optional<size_t> SemmetyStandInWindow::focusHistoryIndex() const {
+	if (lastFocused == 0) { return std::nullopt; }
+
+	return s_focusStamp - lastFocused;
+}
+
+CBox SemmetyStandInWindow::box() const { return position; }
+
+std::string SemmetyStandInWindow::title() const { return std::format("window {}", m_id); }
+
+uintptr_t SemmetyStandInWindow::id() const { return m_id; }
+
+//
+// SemmetyStandInWorkspace
+//
+
+SemmetyStandInWorkspace::SemmetyStandInWorkspace(CBox geometry, bool active):
+    SemmetyWorkspace(SemmetyLeafFrame::create()), active(active) {
+	setRootGeometry(geometry);
+}
+
+void SemmetyStandInWorkspace::placeWindow(SemmetyLeafFrame& frame) {
+	auto window = dynamicPointerCast<SemmetyStandInWindow>(frame.getWindow());
+	if (!window) { return; }
+
+	frame.geometry.round();
+	window->hidden = false;
+	window->position = frame.geometry;
+	placements += 1;
+}
+
+void SemmetyStandInWorkspace::focusWindow(const SemmetyWindowRef& window) {
+	if (focusedWindow == window) { return; }
+
+	focusedWindow = window;
+	if (auto standIn = dynamicPointerCast<SemmetyStandInWindow>(window)) {
+		standIn->hidden = false;
+		standIn->lastFocused = ++SemmetyStandInWindow::s_focusStamp;
+	}
+}
+
+SemmetyWindowRef SemmetyStandInWorkspace::getFocusedWindow() const { return focusedWindow; }
+
+bool SemmetyStandInWorkspace::isActiveWorkspace() const { return active; }
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/math/Box.hpp>
+
+#include "SemmetyWindow.hpp"
+#include "SemmetyWorkspace.hpp"
+
+// Stand-ins for the compositor, to drive the layout core headlessly from benchmarks and tools. A
+// window only remembers what the core told it, the workspace keeps a focus history like Hyprland's.
+
+class SemmetyStandInWindow: public ISemmetyWindow {
+public:
+	explicit SemmetyStandInWindow(uint64_t id, bool floating = false);
+
+	static SP<SemmetyStandInWindow> create(uint64_t id, bool floating = false);
+
+	bool floating = false;
+	bool hidden = false;
+	bool mapped = true;
+	// where the layout last placed the window, or where a floating one was put
+	Hyprutils::Math::CBox position;
+	// the focus stamp when the window was last focused, 0 if never
+	uint64_t lastFocused = 0;
+
+	bool isFloating() const override;
+	bool isHidden() const override;
+	void setHidden(bool hidden) override;
+	bool isMapped() const override;
+	std::optional<size_t> focusHistoryIndex() const override;
+	Hyprutils::Math::CBox box() const override;
+	std::string title() const override;
+	uintptr_t id() const override;
+
+	// bumped on every focus change, shared by all stand-in windows like Hyprland's history
+	inline static uint64_t s_focusStamp = 0;
+
+private:
+	uint64_t m_id;
+};
+
+class SemmetyStandInWorkspace: public SemmetyWorkspace {
+public:
+	explicit SemmetyStandInWorkspace(Hyprutils::Math::CBox geometry, bool active = true);
+
+	bool active = true;
+	SemmetyWindowRef focusedWindow;
+	uint64_t placements = 0;
+
+	void placeWindow(SemmetyLeafFrame& frame) override;
+	void focusWindow(const SemmetyWindowRef& window) override;
+	SemmetyWindowRef getFocusedWindow() const override;
+	bool isActiveWorkspace() const override;
+};
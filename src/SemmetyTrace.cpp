@@ -0,0 +1,291 @@
+#include "SemmetyTrace.hpp"
+#include <bit>
+#include <cmath>
+#include <iterator>
+
+#include <hyprutils/memory/SharedPtr.hpp>
+
+static constexpr std::string_view TRACE_MAGIC = "semmetytrace1\n";
+
+static void writeVarint(std::string& out, uint64_t value) {
+	while (value >= 0x80) {
+		out += (char) ((value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	out += (char) value;
+}
+
+static void writeSigned(std::string& out, int64_t value) {
+	writeVarint(out, ((uint64_t) value << 1) ^ (uint64_t) (value >> 63));
+}
+
+static void writeDouble(std::string& out, double value) {
+	const auto bits = std::bit_cast<uint64_t>(value);
+	for (int i = 0; i < 8; i++) { out += (char) ((bits >> (i * 8)) & 0xff); }
+}
+
+static void writeString(std::string& out, const std::string& value) {
+	writeVarint(out, value.size());
+	out += value;
+}
+
+static void writeBox(std::string& out, const CBox& box) {
+	writeDouble(out, box.x);
+	writeDouble(out, box.y);
+	writeDouble(out, box.width);
+	writeDouble(out, box.height);
+}
+
+//
+// SemmetyTraceWriter
+//
+
+bool SemmetyTraceWriter::open(const std::string& path) {
+	close();
+
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file) { return false; }
+
+	file << TRACE_MAGIC;
+	start = std::chrono::steady_clock::now();
+	lastTime = 0;
+	return true;
+}
+
+void SemmetyTraceWriter::close() {
+	if (file.is_open()) { file.close(); }
+}
+
+bool SemmetyTraceWriter::isOpen() const { return file.is_open(); }
+
+void SemmetyTraceWriter::write(SemmetyTraceRecord record) {
+	if (!file.is_open()) { return; }
+
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+	std::string out;
+	out += (char) record.event;
+	writeVarint(out, record.time - lastTime);
+	lastTime = record.time;
+
+	switch (record.event) {
+	case SemmetyTraceEvent::Workspace:
+		writeSigned(out, record.workspace);
+		writeBox(out, record.box);
+		break;
+	case SemmetyTraceEvent::Dispatch:
+		writeSigned(out, record.workspace);
+		writeString(out, record.name);
+		writeString(out, record.args);
+		break;
+	case SemmetyTraceEvent::NewTarget:
+	case SemmetyTraceEvent::Focus:
+		writeSigned(out, record.workspace);
+		writeVarint(out, record.window);
+		out += (char) record.flag;
+		break;
+	case SemmetyTraceEvent::RemoveTarget:
+		writeSigned(out, record.workspace);
+		writeVarint(out, record.window);
+		break;
+	case SemmetyTraceEvent::Recalculate:
+		writeSigned(out, record.workspace);
+		writeBox(out, record.box);
+		out += (char) record.flag;
+		break;
+	case SemmetyTraceEvent::ResizeTarget:
+		writeSigned(out, record.workspace);
+		writeVarint(out, record.window);
+		writeDouble(out, record.delta.x);
+		writeDouble(out, record.delta.y);
+		out += (char) record.corner;
+		break;
+	case SemmetyTraceEvent::Hash:
+		writeSigned(out, record.workspace);
+		writeVarint(out, record.hash);
+		break;
+	}
+
+	file.write(out.data(), out.size());
+}
+
+//
+// SemmetyTraceReader
+//
+
+std::optional<std::string> SemmetyTraceReader::open(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) { return "could not open " + path; }
+
+	data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	if (!data.starts_with(TRACE_MAGIC)) { return path + " is not a semmety trace"; }
+
+	offset = TRACE_MAGIC.size();
+	time = 0;
+	truncated = false;
+	return std::nullopt;
+}
+
+std::optional<SemmetyTraceRecord> SemmetyTraceReader::next() {
+	if (offset >= data.size()) { return std::nullopt; }
+
+	auto pos = offset;
+	bool ok = true;
+
+	const auto readByte = [&]() -> uint8_t {
+		if (pos >= data.size()) {
+			ok = false;
+			return 0;
+		}
+
+		return (uint8_t) data[pos++];
+	};
+
+	const auto readVarint = [&]() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64 && ok; shift += 7) {
+			const auto byte = readByte();
+			value |= (uint64_t) (byte & 0x7f) << shift;
+			if (!(byte & 0x80)) { break; }
+		}
+
+		return value;
+	};
+
+	const auto readSigned = [&]() {
+		const auto value = readVarint();
+		return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+	};
+
+	const auto readDouble = [&]() {
+		uint64_t bits = 0;
+		for (int i = 0; i < 8; i++) { bits |= (uint64_t) readByte() << (i * 8); }
+		return std::bit_cast<double>(bits);
+	};
+
+	const auto readString = [&]() {
+		const auto size = readVarint();
+		if (!ok || size > data.size() - pos) {
+			ok = false;
+			return std::string();
+		}
+
+		auto value = data.substr(pos, size);
+		pos += size;
+		return value;
+	};
+
+	const auto readBox = [&]() {
+		const auto x = readDouble();
+		const auto y = readDouble();
+		const auto width = readDouble();
+		const auto height = readDouble();
+		return CBox(x, y, width, height);
+	};
+
+	SemmetyTraceRecord record;
+	record.event = (SemmetyTraceEvent) readByte();
+	record.time = time + readVarint();
+
+	switch (record.event) {
+	case SemmetyTraceEvent::Workspace:
+		record.workspace = readSigned();
+		record.box = readBox();
+		break;
+	case SemmetyTraceEvent::Dispatch:
+		record.workspace = readSigned();
+		record.name = readString();
+		record.args = readString();
+		break;
+	case SemmetyTraceEvent::NewTarget:
+	case SemmetyTraceEvent::Focus:
+		record.workspace = readSigned();
+		record.window = readVarint();
+		record.flag = readByte();
+		break;
+	case SemmetyTraceEvent::RemoveTarget:
+		record.workspace = readSigned();
+		record.window = readVarint();
+		break;
+	case SemmetyTraceEvent::Recalculate:
+		record.workspace = readSigned();
+		record.box = readBox();
+		record.flag = readByte();
+		break;
+	case SemmetyTraceEvent::ResizeTarget:
+		record.workspace = readSigned();
+		record.window = readVarint();
+		record.delta.x = readDouble();
+		record.delta.y = readDouble();
+		record.corner = (ResizeCorner) readByte();
+		break;
+	case SemmetyTraceEvent::Hash:
+		record.workspace = readSigned();
+		record.hash = readVarint();
+		break;
+	default: ok = false;
+	}
+
+	if (!ok) {
+		truncated = true;
+		offset = data.size();
+		return std::nullopt;
+	}
+
+	offset = pos;
+	time = record.time;
+	return record;
+}
+
+//
+// hashWorkspaceTree
+//
+
+// FNV-1a
+static void hashValue(uint64_t& hash, uint64_t value) {
+	for (int i = 0; i < 8; i++) {
+		hash ^= (value >> (i * 8)) & 0xff;
+		hash *= 0x100000001b3;
+	}
+}
+
+static void hashBox(uint64_t& hash, const CBox& box) {
+	hashValue(hash, (uint64_t) std::lround(box.x));
+	hashValue(hash, (uint64_t) std::lround(box.y));
+	hashValue(hash, (uint64_t) std::lround(box.width));
+	hashValue(hash, (uint64_t) std::lround(box.height));
+}
+
+static void
+hashFrame(uint64_t& hash, const SP<SemmetyFrame>& frame, const SP<SemmetyFrame>& focus) {
+	hashBox(hash, frame->geometry);
+
+	if (frame->isLeaf()) {
+		const auto window = frame->asLeaf()->getWindow();
+		hashValue(hash, 1);
+		hashValue(hash, window ? window->id() : 0);
+		hashValue(hash, frame == focus);
+		return;
+	}
+
+	const auto split = frame->asSplit();
+	hashValue(hash, 2);
+	hashValue(hash, (uint64_t) split->splitDirection);
+	hashValue(hash, std::bit_cast<uint32_t>(split->splitRatio));
+	hashFrame(hash, split->getChildren().first, focus);
+	hashFrame(hash, split->getChildren().second, focus);
+}
+
+uint64_t hashWorkspaceTree(SemmetyWorkspace& workspace) {
+	uint64_t hash = 0xcbf29ce484222325;
+
+	hashFrame(hash, workspace.getRoot(), workspace.getFocusedFrame());
+
+	for (const auto& window: workspace.windows) {
+		hashValue(hash, window->id());
+		hashValue(hash, window->isFloating());
+	}
+
+	return hash;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include <hyprutils/math/Box.hpp>
+#include <hyprutils/math/Vector2D.hpp>
+
+#include "SemmetyFrameUtils.hpp"
+#include "SemmetyWorkspace.hpp"
+
+// A recording of the entry points the plugin received, enough to run the same sequence against
+// the stand-in. The file starts with "semmetytrace1\n", followed by records of one event byte, the
+// nanoseconds since the previous record as a varint and the fields used by that event.
+
+enum class SemmetyTraceEvent : uint8_t {
+	// a workspace wrapper was created with `box` as its root geometry
+	Workspace = 1,
+	// semmety:`name` was dispatched with `args` on `workspace`
+	Dispatch = 2,
+	// newTarget for `window`, `flag` is whether it was floating
+	NewTarget = 3,
+	RemoveTarget = 4,
+	// Hyprland focused `window`, `flag` is whether it was floating
+	Focus = 5,
+	// recalculate set the root geometry of `workspace` to `box`, `flag` is whether it reflowed
+	Recalculate = 6,
+	// resizeTarget on `window` by `delta` from `corner`
+	ResizeTarget = 7,
+	// the tree hash of `workspace` when the recording stopped
+	Hash = 8,
+};
+
+struct SemmetyTraceRecord {
+	SemmetyTraceEvent event = SemmetyTraceEvent::Workspace;
+	// nanoseconds since the recording started
+	uint64_t time = 0;
+	int64_t workspace = 0;
+	uint64_t window = 0;
+	bool flag = false;
+	CBox box;
+	Vector2D delta;
+	ResizeCorner corner = ResizeCorner::None;
+	std::string name;
+	std::string args;
+	uint64_t hash = 0;
+};
+
+class SemmetyTraceWriter {
+public:
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const;
+	// Stamps the record with the current time and appends it.
+	void write(SemmetyTraceRecord record);
+
+private:
+	std::ofstream file;
+	std::chrono::steady_clock::time_point start;
+	uint64_t lastTime = 0;
+};
+
+class SemmetyTraceReader {
+public:
+	// Reads the whole file, returns an error message if it is not a trace.
+	std::optional<std::string> open(const std::string& path);
+	// The next record, nullopt at the end or at a record cut short by a crash (see truncated).
+	std::optional<SemmetyTraceRecord> next();
+
+	bool truncated = false;
+
+private:
+	std::string data;
+	size_t offset = 0;
+	uint64_t time = 0;
+};
+
+// Hash of the frame tree, window list and focused frame of `workspace`. Windows are hashed by
+// id(), so a replay with stand-in windows that reuse the recorded ids hashes the same as the
+// recording.
+uint64_t hashWorkspaceTree(SemmetyWorkspace& workspace);
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/math/Box.hpp>
+
+// What the layout core needs from a window. The plugin wraps Hyprland windows (SemmetyHyprWindow),
+// SemmetyStandInWindow lets the core run without a compositor. Windows are compared by handle, so
+// there must only ever be one handle per window.
+class ISemmetyWindow {
+public:
+	virtual ~ISemmetyWindow() = default;
+
+	virtual bool isFloating() const = 0;
+	virtual bool isHidden() const = 0;
+	virtual void setHidden(bool hidden) = 0;
+	virtual bool isMapped() const = 0;
+	// 0 for the most recently focused window, nullopt if it was never focused
+	virtual std::optional<size_t> focusHistoryIndex() const = 0;
+	virtual Hyprutils::Math::CBox box() const = 0;
+	virtual std::string title() const = 0;
+	// shown as hex in debug output and used as the bar address
+	virtual uintptr_t id() const = 0;
+};
+
+using SemmetyWindowRef = SP<ISemmetyWindow>;
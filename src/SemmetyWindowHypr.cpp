@@ -0,0 +1,58 @@
+#include "SemmetyWindowHypr.hpp"
+#include <unordered_map>
+
+#include <hyprland/src/desktop/view/Window.hpp>
+#include <hyprutils/memory/SharedPtr.hpp>
+#include <hyprutils/memory/WeakPtr.hpp>
+
+#include "utils.hpp"
+
+SemmetyHyprWindow::SemmetyHyprWindow(PHLWINDOWREF window): window(window) {}
+
+bool SemmetyHyprWindow::isFloating() const { return window && window->m_isFloating; }
+
+bool SemmetyHyprWindow::isHidden() const { return window && window->isHidden(); }
+
+void SemmetyHyprWindow::setHidden(bool hidden) {
+	if (window) { window->setHidden(hidden); }
+}
+
+bool SemmetyHyprWindow::isMapped() const { return valid(window) && window->m_isMapped; }
+
+std::optional<size_t> SemmetyHyprWindow::focusHistoryIndex() const {
+	return getFocusHistoryIndex(window.lock());
+}
+
+CBox SemmetyHyprWindow::box() const {
+	if (!window) { return {}; }
+
+	return CBox(window->m_position, window->m_size);
+}
+
+std::string SemmetyHyprWindow::title() const { return window ? window->m_title : ""; }
+
+uintptr_t SemmetyHyprWindow::id() const { return (uintptr_t) window.get(); }
+
+// Handles are only held weakly here, a window gets a new one after every workspace let go of it.
+static std::unordered_map<PHLWINDOWREF, WP<ISemmetyWindow>> windowHandles;
+
+SemmetyWindowRef toSemmetyWindow(PHLWINDOWREF window) {
+	if (!window) { return {}; }
+
+	if (auto it = windowHandles.find(window); it != windowHandles.end()) {
+		if (auto handle = it->second.lock()) { return handle; }
+	}
+
+	std::erase_if(windowHandles, [](const auto& entry) {
+		return entry.first.expired() || entry.second.expired();
+	});
+
+	SemmetyWindowRef handle = makeShared<SemmetyHyprWindow>(window);
+	windowHandles[window] = handle;
+	return handle;
+}
+
+PHLWINDOWREF toHyprWindow(const SemmetyWindowRef& window) {
+	auto hyprWindow = dynamicPointerCast<SemmetyHyprWindow>(window);
+	return hyprWindow ? hyprWindow->window : PHLWINDOWREF {};
+}
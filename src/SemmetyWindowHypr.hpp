@@ -0,0 +1,27 @@
+#pragma once
+
+#include <hyprland/src/desktop/DesktopTypes.hpp>
+
+#include "SemmetyWindow.hpp"
+
+// The layout core's handle for a Hyprland window.
+class SemmetyHyprWindow: public ISemmetyWindow {
+public:
+	explicit SemmetyHyprWindow(PHLWINDOWREF window);
+
+	PHLWINDOWREF window;
+
+	bool isFloating() const override;
+	bool isHidden() const override;
+	void setHidden(bool hidden) override;
+	bool isMapped() const override;
+	std::optional<size_t> focusHistoryIndex() const override;
+	CBox box() const override;
+	std::string title() const override;
+	uintptr_t id() const override;
+};
+
+// The handle for `window`, the same one for as long as any workspace holds it. Null for a null
+// window.
+SemmetyWindowRef toSemmetyWindow(PHLWINDOWREF window);
+PHLWINDOWREF toHyprWindow(const SemmetyWindowRef& window);
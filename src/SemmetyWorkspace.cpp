@@ -0,0 +1,613 @@
+#include "SemmetyWorkspace.hpp"
+#include <algorithm>
+#include <format>
+#include <functional>
+#include <ranges>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "SemmetyError.hpp"
+#include "SemmetyFrameUtils.hpp"
+
+SemmetyWorkspace::SemmetyWorkspace(SP<SemmetyLeafFrame> root): root(root), focused_frame(root) {
+	root->setFramePath({}); // Empty path for root
+}
+
+void SemmetyWorkspace::putWindowInFrame(
+    const SemmetyWindowRef& window,
+    SP<SemmetyLeafFrame> frame
+) {
+	if (!window) { return; }
+
+	const auto replacedWindow = frame->replaceWindow(*this, window);
+
+	// Don't focus the window unless it is on the active workspace. This prevents active workspace
+	// changing when a window is addded to an inactive workspace.
+	if (isActiveWorkspace()) { focusWindow(window); }
+
+	if (!replacedWindow) { return; }
+
+	auto emptyFrame = getLargestEmptyFrame();
+	if (!emptyFrame) {
+		replacedWindow->setHidden(true);
+		return;
+	}
+
+	emptyFrame->setWindow(*this, replacedWindow);
+}
+
+void SemmetyWorkspace::putWindowInFocussedFrame(const SemmetyWindowRef& window) {
+	putWindowInFrame(window, focused_frame);
+}
+
+SP<SemmetyLeafFrame> SemmetyWorkspace::getLargestEmptyFrame() {
+	auto emptyFrames = root->getEmptyFrames();
+	auto largestEmptyFrame =
+	    std::min_element(emptyFrames.begin(), emptyFrames.end(), frameAreaGreater);
+
+	if (largestEmptyFrame == emptyFrames.end()) { return nullptr; }
+
+	return *largestEmptyFrame;
+}
+
+void SemmetyWorkspace::addWindow(const SemmetyWindowRef& window) {
+	if (!window) { semmety_critical_error("add window called with an invalid window"); }
+
+	windows.push_back(window);
+	if (!window->isFloating()) { putWindowInFocussedFrame(window); }
+}
+
+void SemmetyWorkspace::setWindowTiled(const SemmetyWindowRef& window, bool isTiled) {
+	if (!window) {
+		// TODO: blow up in debug mode?
+		return;
+	}
+
+	if (isTiled) {
+		auto frame = getMostOverlappingLeafFrame(*this, window);
+		if (!frame) { frame = getLargestEmptyFrame(); }
+
+		if (!frame) { frame = root->getLastFocussedLeaf(); }
+
+		if (!frame) {
+			semmety_critical_error(
+			    "frame is null, this should no be possible, getLastFocussedLeaf "
+			    "should always return something"
+			);
+		}
+
+		putWindowInFrame(window, frame);
+		setFocusedFrame(frame);
+	} else {
+		auto frameWithWindow = getFrameForWindow(window);
+		if (!frameWithWindow) { return; }
+
+		auto newWindow = getNextWindowForFrame(frameWithWindow);
+		auto _removedWindow = frameWithWindow->replaceWindow(*this, newWindow);
+	}
+}
+
+void SemmetyWorkspace::removeWindow(const SemmetyWindowRef& window) {
+	// Clean up frame → windows mapping
+	for (auto& [key, vec]: frameHistoryMap) {
+		vec.erase(std::remove(vec.begin(), vec.end(), window), vec.end());
+	}
+
+	// Clean up window → frames mapping
+	windowFrameHistory.erase(window);
+
+	auto frameWithWindow = getFrameForWindow(window);
+	if (!frameWithWindow) {
+		auto it = findWindowIt(window);
+		if (it == windows.end()) { return; }
+
+		windows.erase(it);
+		return;
+	}
+
+	auto newWindow = getNextWindowForFrame(frameWithWindow);
+	auto _removedWindow = frameWithWindow->replaceWindow(*this, newWindow);
+	if (newWindow && frameWithWindow == focused_frame) { focusWindow(newWindow); }
+
+	auto it = findWindowIt(window);
+	if (it == windows.end()) { return; }
+
+	windows.erase(it);
+}
+
+std::vector<SemmetyWindowRef>::iterator
+SemmetyWorkspace::findWindowIt(const SemmetyWindowRef& window) {
+	return std::find(windows.begin(), windows.end(), window);
+}
+
+SemmetyWindowRef SemmetyWorkspace::getNextWindowForFrame(SP<SemmetyLeafFrame> frame) {
+	const auto path = frame->getPathString();
+	auto& vec = frameHistoryMap[path];
+
+	for (auto& window: std::views::reverse(vec)) {
+		// The most recent window for a frame will be the one which is still in it, so this will skip
+		// that window
+		if (!window || isWindowVisible(window)) { continue; }
+
+		return window;
+	}
+
+	GetNextWindowParams params = nextTiledWindowParams;
+	if (auto window = frame->getWindow()) {
+		params.startFromIndex = std::distance(windows.begin(), findWindowIt(window));
+	}
+
+	return getNextWindow(params);
+}
+
+bool SemmetyWorkspace::isWindowVisible(const SemmetyWindowRef& window) const {
+	if (window->isFloating()) { return !window->isHidden(); }
+
+	// we don't use isHidden for tiled windows
+	return isWindowInFrame(window);
+}
+
+// get the index of the the most recently focused window in this workspace which was not hidden
+size_t SemmetyWorkspace::getLastFocusedWindowIndex() {
+	std::optional<size_t> minFocusIndex;
+	size_t minIdx = 0;
+
+	for (size_t idx = 0; idx < windows.size(); ++idx) {
+		const auto& window = windows[idx];
+		if (!isWindowVisible(window)) { continue; }
+
+		if (auto focus = window->focusHistoryIndex()) {
+			if (!minFocusIndex || *focus < *minFocusIndex) {
+				minFocusIndex = *focus;
+				minIdx = idx;
+			}
+		}
+	}
+
+	return minIdx;
+}
+
+static bool windowMatchesMode(const SemmetyWindowRef& window, SemmetyWindowMode mode) {
+	if (!window) { return false; }
+
+	switch (mode) {
+	case SemmetyWindowMode::Either: return true;
+	case SemmetyWindowMode::Tiled: return !window->isFloating();
+	case SemmetyWindowMode::Floating: return window->isFloating();
+	}
+
+	return false;
+}
+
+bool SemmetyWorkspace::windowMatchesVisibility(
+    const SemmetyWindowRef& window,
+    SemmetyWindowVisibility mode
+) {
+	if (!window) { return false; }
+
+	switch (mode) {
+	case SemmetyWindowVisibility::Either: return true;
+	case SemmetyWindowVisibility::Visible: return isWindowVisible(window);
+	case SemmetyWindowVisibility::Hidden: return !isWindowVisible(window);
+	}
+
+	return false;
+}
+
+SemmetyWindowRef SemmetyWorkspace::getNextWindow(const GetNextWindowParams& params) {
+	auto windowMode = params.windowMode.value_or(SemmetyWindowMode::Either);
+	auto windowVisibility = params.windowVisibility.value_or(SemmetyWindowVisibility::Either);
+	auto backward = params.backward.value_or(false);
+
+	if (windows.size() == 0) { return {}; }
+
+	auto advanceIndex = [&](size_t currentIndex) -> size_t {
+		return (windows.size() + currentIndex + (backward ? -1 : 1)) % windows.size();
+	};
+
+	size_t index;
+	if (params.startFromIndex.has_value()) {
+		index = params.startFromIndex.value() % windows.size();
+	} else {
+		index = getLastFocusedWindowIndex() % windows.size();
+		index = advanceIndex(index);
+	}
+
+	for (size_t i = 0; i < windows.size(); i++) {
+		const auto& window = windows[index];
+
+		if (windowMatchesMode(window, windowMode) && windowMatchesVisibility(window, windowVisibility))
+		{
+			return window;
+		}
+
+		index = advanceIndex(index);
+	}
+
+	return {};
+}
+
+SP<SemmetyLeafFrame> SemmetyWorkspace::getFrameForWindow(const SemmetyWindowRef& window) const {
+	const auto leafFrames = root->getLeafFrames();
+
+	for (const auto& frame: leafFrames) {
+		if (frame->getWindow() == window) { return frame; }
+	}
+
+	return nullptr;
+}
+
+bool SemmetyWorkspace::isWindowInFrame(const SemmetyWindowRef& window) const {
+	return !!getFrameForWindow(window);
+}
+
+SP<SemmetyLeafFrame> SemmetyWorkspace::getFocusedFrame() { return focused_frame; }
+
+void SemmetyWorkspace::setFocusedFrame(SP<SemmetyFrame> frame) {
+	static int focusOrder = 0;
+
+	if (!frame) { semmety_critical_error("Cannot set a null frame as focused"); }
+
+	if (focused_frame == frame) {
+		focusWindow(focused_frame->getWindow());
+		return;
+	}
+
+	const auto previous = focused_frame;
+	focused_frame = frame->getLastFocussedLeaf();
+	focused_frame->focusOrder = ++focusOrder;
+	onFocusedFrameChanged(previous);
+	focusWindow(focused_frame->getWindow());
+}
+
+void SemmetyWorkspace::activateWindow(const SemmetyWindowRef& window) {
+	if (!window) { return; }
+
+	if (window->isFloating()) {
+		raiseWindow(window);
+		return;
+	}
+
+	auto frameWithWindow = getFrameForWindow(window);
+	if (frameWithWindow) {
+		setFocusedFrame(frameWithWindow);
+		return;
+	}
+
+	// TODO: if window is not in workspace?
+	putWindowInFocussedFrame(window);
+}
+
+void SemmetyWorkspace::jumpToWindow(const SemmetyWindowRef& window, int mode) {
+	if (!window) { return; }
+
+	if (mode == 0 || window->isFloating()) {
+		activateWindow(window);
+		return;
+	}
+
+	auto frameWithWindow = getFrameForWindow(window);
+	if (frameWithWindow) {
+		activateWindow(window);
+		return;
+	}
+
+	auto frameHistory = getWindowFrameHistory(window);
+	for (auto it = frameHistory.rbegin(); it != frameHistory.rend(); ++it) {
+		const auto& pathString = *it;
+
+		auto frame = root->findRecursive([&pathString](const SP<SemmetyFrame>& f) {
+			return f && f->getPathString() == pathString;
+		});
+
+		if (!frame || !frame->isLeaf()) { continue; }
+
+		auto leafFrame = frame->asLeaf();
+		putWindowInFrame(window, leafFrame);
+		setFocusedFrame(leafFrame);
+
+		return;
+	}
+
+	activateWindow(window);
+}
+
+void SemmetyWorkspace::updateFrameHistory(SP<SemmetyFrame> frame, const SemmetyWindowRef& window) {
+	const auto path = frame->getPathString();
+
+	// Update frame → windows mapping
+	auto& frameVec = frameHistoryMap[path];
+	frameVec.erase(std::remove(frameVec.begin(), frameVec.end(), window), frameVec.end());
+	frameVec.push_back(window);
+
+	// Update window → frames mapping (deduplicate)
+	auto& windowVec = windowFrameHistory[window];
+	windowVec.erase(std::remove(windowVec.begin(), windowVec.end(), path), windowVec.end());
+	windowVec.push_back(path);
+}
+
+std::vector<std::string>
+SemmetyWorkspace::getWindowFrameHistory(const SemmetyWindowRef& window) const {
+	auto it = windowFrameHistory.find(window);
+	if (it == windowFrameHistory.end()) {
+		return {}; // Window not found or has no history
+	}
+	return it->second; // Return copy of history vector
+}
+
+std::string SemmetyWorkspace::getDebugString() {
+	std::string out = "tiles:\n" + root->print(*this);
+
+	const auto focusedWindow = getFocusedWindow();
+
+	out += "\nwindows:\n";
+	for (const auto& window: windows) {
+		if (!window) {
+			out += "window is null";
+			continue;
+		}
+
+		const auto ptrString = std::format("{:x}", window->id());
+		const auto focusString = focusedWindow == window ? "focus" : "     ";
+		const auto hiddenString = isWindowVisible(window) ? "visible" : "hidden ";
+		const auto floatingString = window->isFloating() ? "floating" : "tiled   ";
+		const auto frameString = isWindowInFrame(window) ? "inframe" : "       ";
+		const auto mappedString = window->isMapped() ? "mapped  " : "unmapped";
+		const auto actualHiddenString = window->isHidden() ? "ishidden" : "        ";
+
+		// Check for mismatch: frame thinks window is visible but it's actually unmapped or hidden
+		std::string warning = "";
+		if (isWindowInFrame(window) && (!window->isMapped() || window->isHidden())) {
+			warning = " [MISMATCH!]";
+		}
+
+		out += std::format(
+		    "{} {} {} {} {} {} {} {}{}\n",
+		    ptrString,
+		    focusString,
+		    hiddenString,
+		    floatingString,
+		    frameString,
+		    mappedString,
+		    actualHiddenString,
+		    window->title(),
+		    warning
+		);
+	}
+
+	return out;
+}
+
+void SemmetyWorkspace::changeWindowOrder(bool prev) {
+	if (windows.size() < 2) { return; }
+
+	auto focusedWindow = getFocusedWindow();
+	if (!focusedWindow) { return; }
+	auto it = findWindowIt(focusedWindow);
+	size_t index = std::distance(windows.begin(), it);
+	int offset = prev ? -1 : 1;
+	size_t n = windows.size();
+
+	size_t finalPos = (index + offset + n) % n;
+
+	auto window = windows[index];
+	windows.erase(windows.begin() + index);
+
+	windows.insert(windows.begin() + finalPos, window);
+}
+
+std::vector<std::string> SemmetyWorkspace::testInvariants() {
+	std::vector<std::string> errors;
+
+	// 1. Check that root is non-null.
+	if (!root) { errors.push_back("Invariant violation: root is null."); }
+
+	// 2. Check that all window pointers in windows are non-null.
+	for (size_t i = 0; i < windows.size(); ++i) {
+		if (windows[i] == nullptr) {
+			errors.push_back(std::format("Invariant violation: workspace.windows[{}] is null.", i));
+		}
+	}
+
+	// 3. Check that all windows in windows are unique.
+	std::unordered_set<SemmetyWindowRef> workspaceWindowSet;
+	for (size_t i = 0; i < windows.size(); ++i) {
+		const auto& w = windows[i];
+		if (!w) { continue; }
+
+		if (workspaceWindowSet.find(w) != workspaceWindowSet.end()) {
+			errors.push_back(
+			    std::format(
+			        "Invariant violation: Duplicate window pointer found in workspace.windows at index "
+			        "{}.",
+			        i
+			    )
+			);
+		} else {
+			workspaceWindowSet.insert(w);
+		}
+	}
+
+	// 4. Traverse the frame tree starting at root to perform several frame-related checks.
+	// We'll collect all frames, and also check that each frame is unique.
+	std::vector<SP<SemmetyFrame>> allFrames;
+	std::unordered_set<SemmetyFrame*> frameSet;
+
+	if (root) { traverseFramesForInvariants(root, errors, frameSet, allFrames); }
+
+	// 5. Check that in leaf frames:
+	// - window pointer is non-null (if the frame is not empty),
+	// - windows in frames are unique,
+	// - and that windows in frames are not minimized/hidden.
+	std::unordered_set<SemmetyWindowRef> frameWindowSet;
+	for (const auto& frame: allFrames) {
+		if (!frame->isLeaf()) { continue; }
+
+		auto leafFrame = frame->asLeaf();
+		if (leafFrame->isEmpty()) { continue; }
+
+		auto window = leafFrame->getWindow();
+		if (window == nullptr) {
+			errors.push_back("Invariant violation: Leaf frame contains a null window pointer.");
+			continue;
+		}
+
+		// Check uniqueness of windows in frames.
+		if (frameWindowSet.find(window) != frameWindowSet.end()) {
+			errors.push_back("Invariant violation: Duplicate window pointer found in frames.");
+		} else {
+			frameWindowSet.insert(window);
+		}
+
+		// Check that window visibility state matches actual hidden state
+		// For tiled windows in frames, isWindowVisible returns true if in frame
+		// But the actual window might still be hidden
+		if (isWindowInFrame(window) && (window->isHidden() || !window->isMapped())) {
+			errors.push_back(
+			    std::format(
+			        "Invariant violation: Window in frame is actually hidden or unmapped. Title: '{}'",
+			        window->title()
+			    )
+			);
+		}
+	}
+
+	// 6. There should be no empty leaf frames if there are minimized windows.
+	// bool hasMinimizedWindow = false;
+	// for (const auto& w: windows) {
+	// 	if (isWindowMinimized(w)) {
+	// 		hasMinimizedWindow = true;
+	// 		break;
+	// 	}
+	// }
+
+	// if (hasMinimizedWindow) {
+	// 	for (const auto& frame: allFrames) {
+	// 		if (!frame->isLeaf()) {
+	// 			continue;
+	// 		}
+
+	// 		auto leafFrame = frame->asLeaf();
+	// 		if (leafFrame->isEmpty()) {
+	// 			errors.push_back("Invariant violation: An empty leaf frame exists despite the presence "
+	// 			                 "of minimized windows.");
+	// 		}
+	// 	}
+	// }
+
+	// // 7. Windows not assigned to any frame should be hidden/minimized.
+	// // For every window in windows that does not appear in a frame, check that it is
+	// // minimized.
+	// for (const auto& w: windows) {
+	// 	if (isWindowMinimized(w) && !w->isHidden()) {
+	// 		errors.push_back(std::format(
+	// 		    "Invariant violation: Window not assigned to any frame is not hidden. {}",
+	// 		    w->fetchTitle()
+	// 		));
+	// 	}
+	// }
+
+	// 8. Verify all frame paths are correct by comparing cached vs computed
+	if (root) {
+		std::function<void(SP<SemmetyFrame>)> verifyPaths = [&](SP<SemmetyFrame> frame) {
+			if (!frame) { return; }
+
+			const auto cachedPath = frame->getPathString();
+			const auto computedPath = getFramePath(frame, root);
+
+			if (cachedPath != computedPath) {
+				errors.push_back(std::format(
+				    "Invariant violation: Frame path mismatch. Cached='{}', Computed='{}'",
+				    cachedPath,
+				    computedPath
+				));
+			}
+
+			if (frame->isSplit()) {
+				const auto& children = frame->asSplit()->getChildren();
+				verifyPaths(children.first);
+				verifyPaths(children.second);
+			}
+		};
+
+		verifyPaths(root);
+	}
+
+	// 9. Verify windowFrameHistory consistency with frameHistoryMap
+	for (const auto& [window, framePaths]: windowFrameHistory) {
+		for (const auto& framePath: framePaths) {
+			// Verify that if window is in windowFrameHistory[W] with frame F,
+			// then window is also in frameHistoryMap[F]
+			auto frameIt = frameHistoryMap.find(framePath);
+			if (frameIt == frameHistoryMap.end()) {
+				errors.push_back(std::format(
+				    "Invariant violation: Window in windowFrameHistory claims to be in frame '{}' but "
+				    "frame has no history",
+				    framePath
+				));
+				continue;
+			}
+
+			const auto& windowsInFrame = frameIt->second;
+			if (std::find(windowsInFrame.begin(), windowsInFrame.end(), window) == windowsInFrame.end()) {
+				errors.push_back(std::format(
+				    "Invariant violation: Window in windowFrameHistory['{}'] but not in "
+				    "frameHistoryMap['{}']",
+				    framePath,
+				    framePath
+				));
+			}
+		}
+	}
+
+	return errors;
+}
+
+const SP<SemmetyFrame>& SemmetyWorkspace::getRoot() const { return root; }
+
+void SemmetyWorkspace::setRootGeometry(const CBox& geometry) { root->geometry = geometry; }
+
+void SemmetyWorkspace::traverseFramesForInvariants(
+    const SP<SemmetyFrame>& frame,
+    std::vector<std::string>& errors,
+    std::unordered_set<SemmetyFrame*>& frameSet,
+    std::vector<SP<SemmetyFrame>>& allFrames
+) {
+	if (!frame) {
+		errors.push_back("Invariant violation: null frame encountered in frame tree.");
+		return;
+	}
+
+	// Check for duplicate frames.
+	if (frameSet.find(frame.get()) != frameSet.end()) {
+		errors.push_back("Invariant violation: Duplicate frame encountered in frame tree.");
+	} else {
+		frameSet.insert(frame.get());
+		allFrames.push_back(frame);
+	}
+
+	if (!frame->isSplit()) { return; }
+
+	// If the frame is a split frame, we need to check:
+	// - both children are valid (non-null)
+	// - then traverse both children.
+	auto splitFrame = frame->asSplit();
+	const auto& children = splitFrame->getChildren();
+	if (!children.first) {
+		errors.push_back("Invariant violation: Split frame has a null first child.");
+	}
+	if (!children.second) {
+		errors.push_back("Invariant violation: Split frame has a null second child.");
+	}
+	if (children.first) { traverseFramesForInvariants(children.first, errors, frameSet, allFrames); }
+	if (children.second) {
+		traverseFramesForInvariants(children.second, errors, frameSet, allFrames);
+	}
+}
+
+SP<SemmetyLeafFrame> SemmetyWorkspace::createLeafFrame() { return SemmetyLeafFrame::create(); }
+
+void SemmetyWorkspace::raiseWindow(const SemmetyWindowRef&) {}
+
+void SemmetyWorkspace::onFocusedFrameChanged(const SP<SemmetyLeafFrame>&) {}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <hyprland/src/helpers/memory/Memory.hpp>
+#include <hyprutils/math/Box.hpp>
+
+#include "SemmetyFrame.hpp"
+#include "SemmetyWindow.hpp"
+
+enum class SemmetyWindowMode {
+	Tiled,
+	Floating,
+	Either,
+};
+
+enum class SemmetyWindowVisibility {
+	Visible,
+	Hidden,
+	Either,
+};
+
+struct GetNextWindowParams {
+	std::optional<bool> backward;
+	std::optional<size_t> startFromIndex;
+	std::optional<SemmetyWindowMode> windowMode;
+	std::optional<SemmetyWindowVisibility> windowVisibility;
+};
+
+const GetNextWindowParams nextTiledWindowParams = {
+    .windowMode = SemmetyWindowMode::Tiled,
+    .windowVisibility = SemmetyWindowVisibility::Hidden,
+};
+
+// The frame tree and window list of one workspace, independent of the compositor. Everything that
+// touches the compositor goes through the virtual hooks at the bottom, which
+// SemmetyWorkspaceWrapper implements for Hyprland and SemmetyStandInWorkspace for headless use.
+class SemmetyWorkspace {
+public:
+	explicit SemmetyWorkspace(SP<SemmetyLeafFrame> root);
+	virtual ~SemmetyWorkspace() = default;
+
+	std::vector<SemmetyWindowRef> windows;
+	std::unordered_map<std::string, std::vector<SemmetyWindowRef>> frameHistoryMap;
+	std::unordered_map<SemmetyWindowRef, std::vector<std::string>> windowFrameHistory;
+
+	size_t getLastFocusedWindowIndex();
+
+	SemmetyWindowRef getNextWindow(const GetNextWindowParams& params = {});
+
+	virtual void addWindow(const SemmetyWindowRef& window);
+	virtual void removeWindow(const SemmetyWindowRef& window);
+	SP<SemmetyLeafFrame> getFocusedFrame();
+	void setFocusedFrame(SP<SemmetyFrame> frame);
+	SP<SemmetyLeafFrame> getFrameForWindow(const SemmetyWindowRef& window) const;
+	std::vector<SemmetyWindowRef>::iterator findWindowIt(const SemmetyWindowRef& window);
+	bool isWindowInFrame(const SemmetyWindowRef& window) const;
+	bool isWindowVisible(const SemmetyWindowRef& window) const;
+	void putWindowInFocussedFrame(const SemmetyWindowRef& window);
+	void setWindowTiled(const SemmetyWindowRef& window, bool isTiled);
+	virtual std::string getDebugString();
+	void changeWindowOrder(bool prev);
+	void activateWindow(const SemmetyWindowRef& window);
+	void jumpToWindow(const SemmetyWindowRef& window, int mode);
+	SP<SemmetyLeafFrame> getLargestEmptyFrame();
+	void updateFrameHistory(SP<SemmetyFrame> frame, const SemmetyWindowRef& window);
+	std::vector<std::string> getWindowFrameHistory(const SemmetyWindowRef& window) const;
+	bool windowMatchesVisibility(const SemmetyWindowRef& window, SemmetyWindowVisibility mode);
+	SemmetyWindowRef getNextWindowForFrame(SP<SemmetyLeafFrame> frame);
+	void putWindowInFrame(const SemmetyWindowRef& window, SP<SemmetyLeafFrame> frame);
+	std::vector<std::string> testInvariants();
+	const SP<SemmetyFrame>& getRoot() const;
+	void setRootGeometry(const CBox& geometry);
+
+	// Frames for new splits. Hosts that keep per-frame state return a subclass.
+	virtual SP<SemmetyLeafFrame> createLeafFrame();
+	// Moves the window of `frame` into the frame's geometry and shows it.
+	virtual void placeWindow(SemmetyLeafFrame& frame) = 0;
+	// Gives the window keyboard focus, a null window clears the focus.
+	virtual void focusWindow(const SemmetyWindowRef& window) = 0;
+	// The window that has keyboard focus, if any.
+	virtual SemmetyWindowRef getFocusedWindow() const = 0;
+	// Focus only follows windows into the workspace that is shown on the focused monitor.
+	virtual bool isActiveWorkspace() const = 0;
+	// Brings the window above the others, for floating windows and windows being swapped.
+	virtual void raiseWindow(const SemmetyWindowRef& window);
+	// Called after getFocusedFrame() changed away from `previous`.
+	virtual void onFocusedFrameChanged(const SP<SemmetyLeafFrame>& previous);
+
+protected:
+	SP<SemmetyFrame> root;
+	SP<SemmetyLeafFrame> focused_frame;
+
+private:
+	void traverseFramesForInvariants(
+	    const SP<SemmetyFrame>& frame,
+	    std::vector<std::string>& errors,
+	    std::unordered_set<SemmetyFrame*>& frameSet,
+	    std::vector<SP<SemmetyFrame>>& allFrames
+	);
+
+	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspace&);
+};
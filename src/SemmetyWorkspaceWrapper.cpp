@@ -1,8 +1,7 @@
 #include "SemmetyWorkspaceWrapper.hpp"
 #include <algorithm>
-#include <functional>
+#include <sstream>
 #include <string>
-#include <unordered_set>
 #include <vector>
 
 #include <format>
@@ -11,27 +10,21 @@
 #include <hyprland/src/desktop/DesktopTypes.hpp>
 #include <hyprland/src/desktop/Workspace.hpp>
 #include <hyprland/src/desktop/state/FocusState.hpp>
-#include <hyprland/src/managers/KeybindManager.hpp>
+#include <hyprland/src/desktop/view/Window.hpp>
 #include <hyprland/src/layout/LayoutManager.hpp>
-#include <hyprland/src/managers/PointerManager.hpp>
-#include <hyprland/src/managers/SeatManager.hpp>
-#include <hyprland/src/managers/input/InputManager.hpp>
+#include <hyprland/src/layout/target/Target.hpp>
 #include <hyprland/src/plugins/PluginAPI.hpp>
-#include <hyprland/src/plugins/PluginSystem.hpp>
 #include <hyprland/src/xwayland/XSurface.hpp>
 #include <hyprutils/math/Vector2D.hpp>
 #include <hyprutils/memory/SharedPtr.hpp>
-#include <hyprutils/memory/WeakPtr.hpp>
-#include <hyprutils/os/FileDescriptor.hpp>
 
-#include "SemmetyFrameUtils.hpp"
+#include "SemmetyFrameHypr.hpp"
+#include "SemmetyWindowHypr.hpp"
 #include "log.hpp"
-#include "src/SemmetyFrame.hpp"
 #include "utils.hpp"
 
-bool isWindowFloating(PHLWINDOWREF window) { return window && window->m_isFloating; }
-
-SemmetyWorkspaceWrapper::SemmetyWorkspaceWrapper(PHLWORKSPACEREF w, SemmetyLayout& l): layout(l) {
+SemmetyWorkspaceWrapper::SemmetyWorkspaceWrapper(PHLWORKSPACEREF w, SemmetyLayout& l):
+    SemmetyWorkspace(SemmetyHyprLeafFrame::create(true)), layout(l) {
 	workspace = w;
 
 	auto& monitor = w->m_monitor;
@@ -39,649 +32,276 @@ SemmetyWorkspaceWrapper::SemmetyWorkspaceWrapper(PHLWORKSPACEREF w, SemmetyLayou
 	auto pos = monitor->m_position + Vector2D(reserved.left(), reserved.top());
 	auto size = monitor->m_size - Vector2D(reserved.left() + reserved.right(), reserved.top() + reserved.bottom());
 
-	auto frame = SemmetyLeafFrame::create({}, true);
-	frame->geometry = CBox(pos, size);
-	frame->setFramePath({}); // Empty path for root
-
-	root = frame;
-	focused_frame = frame;
+	setRootGeometry(CBox(pos, size));
 
-	semmety_log(Log::ERR, "init workspace monitor size {} {}", monitor->m_size.x, monitor->m_size.y);
-	semmety_log(Log::ERR, "workspace has root frame: {}", frame->print(*this));
+	semmety_log(
+	    Layout,
+	    Log::INFO,
+	    "init workspace monitor size {} {}",
+	    monitor->m_size.x,
+	    monitor->m_size.y
+	);
+	semmety_trace(Layout, "workspace has root frame: {}", getRoot()->print(*this));
 }
 
-void SemmetyWorkspaceWrapper::putWindowInFrame(PHLWINDOWREF window, SP<SemmetyLeafFrame> frame) {
-	if (!window) { return; }
-
-	const auto replacedWindow = frame->replaceWindow(*this, window);
-
-	// Don't focus the window unless it is on the active workspace. This prevents active workspace
-	// changing when a window is addded to an inactive workspace.
-	if (workspace == Desktop::focusState()->monitor()->m_activeWorkspace) { focusWindow(window); }
-
-	if (!replacedWindow) { return; }
+void SemmetyWorkspaceWrapper::addWindow(const SemmetyWindowRef& window) {
+	SemmetyWorkspace::addWindow(window);
+	barRevision += 1;
 
-	auto emptyFrame = getLargestEmptyFrame();
-	if (!emptyFrame) {
-		replacedWindow->setHidden(true);
-		return;
+	refreshBarWindow(window);
+	if (auto hyprWindow = toHyprWindow(window); hyprWindow && hyprWindow->m_isUrgent) {
+		markWindowUrgent(hyprWindow);
 	}
-
-	emptyFrame->setWindow(*this, replacedWindow);
 }
 
-void SemmetyWorkspaceWrapper::putWindowInFocussedFrame(PHLWINDOWREF window) {
-	putWindowInFrame(window, focused_frame);
-}
-
-SP<SemmetyLeafFrame> SemmetyWorkspaceWrapper::getLargestEmptyFrame() {
-	auto emptyFrames = root->getEmptyFrames();
-	auto largestEmptyFrame =
-	    std::min_element(emptyFrames.begin(), emptyFrames.end(), frameAreaGreater);
-
-	if (largestEmptyFrame == emptyFrames.end()) { return nullptr; }
+void SemmetyWorkspaceWrapper::removeWindow(const SemmetyWindowRef& window) {
+	std::erase(urgentWindows, toHyprWindow(window));
+	barWindowCache.erase(window);
+	barRevision += 1;
 
-	return *largestEmptyFrame;
+	SemmetyWorkspace::removeWindow(window);
 }
 
-void SemmetyWorkspaceWrapper::addWindow(PHLWINDOWREF window) {
-	if (!window) { semmety_critical_error("add window called with an invalid window"); }
+void SemmetyWorkspaceWrapper::markWindowUrgent(PHLWINDOWREF window) {
+	if (std::ranges::find(urgentWindows, window) != urgentWindows.end()) { return; }
 
-	windows.push_back(window);
-	if (!window->m_isFloating) { putWindowInFocussedFrame(window); }
+	urgentWindows.push_back(window);
+	barRevision += 1;
 }
 
-void SemmetyWorkspaceWrapper::setWindowTiled(PHLWINDOWREF window, bool isTiled) {
-	if (!window) {
-		// TODO: blow up in debug mode?
-		return;
-	}
-
-	if (isTiled) {
-		auto frame = getMostOverlappingLeafFrame(*this, window);
-		if (!frame) { frame = getLargestEmptyFrame(); }
-
-		if (!frame) { frame = root->getLastFocussedLeaf(); }
-
-		if (!frame) {
-			semmety_critical_error(
-			    "frame is null, this should no be possible, getLastFocussedLeaf "
-			    "should always return something"
-			);
-		}
-
-		putWindowInFrame(window, frame);
-		setFocusedFrame(frame);
-	} else {
-		auto frameWithWindow = getFrameForWindow(window);
-		if (!frameWithWindow) { return; }
+void SemmetyWorkspaceWrapper::pruneUrgentWindows() {
+	const auto removed = std::erase_if(urgentWindows, [](const auto& window) {
+		return !window || !window->m_isUrgent;
+	});
 
-		auto newWindow = getNextWindowForFrame(frameWithWindow);
-		auto _removedWindow = frameWithWindow->replaceWindow(*this, newWindow);
-	}
+	if (removed > 0) { barRevision += 1; }
 }
 
-void SemmetyWorkspaceWrapper::removeWindow(PHLWINDOWREF window) {
-	// Clean up frame → windows mapping
-	for (auto& [key, vec]: frameHistoryMap) {
-		vec.erase(std::remove(vec.begin(), vec.end(), window), vec.end());
-	}
-
-	// Clean up window → frames mapping
-	windowFrameHistory.erase(window);
-
-	auto frameWithWindow = getFrameForWindow(window);
-	if (!frameWithWindow) {
-		auto it = findWindowIt(window);
-		if (it == windows.end()) { return; }
+bool SemmetyWorkspaceWrapper::hasUrgentWindow() const {
+	return std::ranges::any_of(urgentWindows, [](const auto& window) {
+		return window && window->m_isUrgent;
+	});
+}
 
-		windows.erase(it);
+void SemmetyWorkspaceWrapper::refreshBarWindow(const SemmetyWindowRef& window) {
+	// an entry for a window of another workspace would never be dropped
+	if (findWindowIt(window) == windows.end()) { return; }
+
+	const auto hyprWindow = toHyprWindow(window);
+	auto title = hyprWindow ? hyprWindow->fetchTitle() : "";
+	auto appid = hyprWindow ? hyprWindow->fetchClass() : "";
+
+	const auto it = barWindowCache.find(window);
+	if (it == barWindowCache.end()) {
+		barRevision += 1;
+		barWindowCache.emplace(
+		    window,
+		    SBarWindowEntry {
+		        .window = SemmetyBarWindow {
+		            .address = std::format("{:x}", window->id()),
+		            .title = std::move(title),
+		            .appid = std::move(appid),
+		        },
+		    }
+		);
 		return;
 	}
 
-	auto newWindow = getNextWindowForFrame(frameWithWindow);
-	auto _removedWindow = frameWithWindow->replaceWindow(*this, newWindow);
-	if (newWindow && frameWithWindow == focused_frame) { focusWindow(newWindow); }
-
-	auto it = findWindowIt(window);
-	if (it == windows.end()) { return; }
+	const auto& cached = *it->second.window;
+	if (cached.title == title && cached.appid == appid) { return; }
 
-	windows.erase(it);
+	// the JSON fragment is rebuilt by the next getBarWindows()
+	barRevision += 1;
+	auto barWindow = cached;
+	barWindow.title = std::move(title);
+	barWindow.appid = std::move(appid);
+	barWindow.jsonFragment.clear();
+	it->second.window = std::move(barWindow);
 }
 
-std::vector<PHLWINDOWREF>::iterator SemmetyWorkspaceWrapper::findWindowIt(PHLWINDOWREF window) {
-	return std::find(windows.begin(), windows.end(), window);
+SP<SemmetyLeafFrame> SemmetyWorkspaceWrapper::createLeafFrame() {
+	return SemmetyHyprLeafFrame::create();
 }
 
-PHLWINDOWREF SemmetyWorkspaceWrapper::getNextWindowForFrame(SP<SemmetyLeafFrame> frame) {
-	const auto path = frame->getPathString();
-	auto& vec = frameHistoryMap[path];
-
-	for (auto& window: std::views::reverse(vec)) {
-		// The most recent window for a frame will be the one which is still in it, so this will skip
-		// that window
-		if (!window || isWindowVisible(window)) { continue; }
-
-		return window;
-	}
-
-	GetNextWindowParams params = nextTiledWindowParams;
-	if (auto window = frame->getWindow()) {
-		params.startFromIndex = std::distance(windows.begin(), findWindowIt(window));
+void SemmetyWorkspaceWrapper::placeWindow(SemmetyLeafFrame& frame) {
+	barRevision += 1;
+	const auto window = toHyprWindow(frame.getWindow());
+
+	if (!valid(window) || !window->m_isMapped) {
+		semmety_log(
+		    Layout,
+		    Log::ERR,
+		    "node {:x} is an unmapped window ({:x}), cannot apply node data, removing from tiled "
+		    "layout",
+		    (uintptr_t) &frame,
+		    (uintptr_t) window.get()
+		);
+		// Handle error notification or removal logic here
+		return;
 	}
 
-	return getNextWindow(params);
-}
+	if (window->isHidden()) { window->setHidden(false); }
 
-bool SemmetyWorkspaceWrapper::isWindowVisible(PHLWINDOWREF window) const {
-	if (window->m_isFloating) { return !window->isHidden(); }
+	window->updateWindowData();
 
-	// we don't use isHidden for tiled windows
-	return isWindowInFrame(window);
-}
+	if (window->isFullscreen()) {
+		const auto& monitor = window->m_monitor;
 
-// get the index of the the most recently focused window in this workspace which was not hidden
-size_t SemmetyWorkspaceWrapper::getLastFocusedWindowIndex() {
-	std::optional<size_t> minFocusIndex;
-	size_t minIdx = 0;
-
-	for (size_t idx = 0; idx < windows.size(); ++idx) {
-		const auto window = windows[idx];
-		if (!isWindowVisible(window)) { continue; }
-
-		if (auto focus = getFocusHistoryIndex(window.lock())) {
-			if (!minFocusIndex || *focus < *minFocusIndex) {
-				minFocusIndex = *focus;
-				minIdx = idx;
-			}
+		*window->m_realPosition = monitor->m_position;
+		*window->m_realSize = monitor->m_size;
+	} else {
+		frame.geometry.round();
+
+		// Position through the window's layout target instead of writing m_realPosition/m_realSize
+		// directly. This keeps Hyprland's m_box consistent (its post-map recalc re-applies it, which
+		// previously clobbered our geometry and broke the open animation) and lets the engine drive
+		// the configured window-open animation (e.g. popin). We pass our exact window rect as
+		// visualBox so updatePos() uses it as-is rather than re-applying its own gap model, which
+		// preserves semmety's gap layout. logicalBox is the node box (the logical/tiled size).
+		// updatePos() adds the window's reserved area itself, so compute visualBox without it.
+		auto visualBox =
+		    getStandardWindowArea(frame, frame.geometry, SBoxExtents {}, workspace.lock());
+
+		if (auto target = window->layoutTarget()) {
+			target->setPositionGlobal(
+			    Layout::STargetBox {.logicalBox = frame.geometry, .visualBox = visualBox}
+			);
 		}
 	}
 
-	return minIdx;
-}
-
-bool windowMatchesMode(PHLWINDOWREF window, SemmetyWindowMode mode) {
-	if (!window) { return false; }
+	// NOTE: we no longer warp m_realPosition/m_realSize here. Positioning now goes through the
+	// layout target (above), so Hyprland animates moves/resizes and plays the window-open animation.
 
-	switch (mode) {
-	case SemmetyWindowMode::Either: return true;
-	case SemmetyWindowMode::Tiled: return !window->m_isFloating;
-	case SemmetyWindowMode::Floating: return window->m_isFloating;
-	}
-
-	return false;
+	window->updateWindowDecos();
 }
 
-bool SemmetyWorkspaceWrapper::windowMatchesVisibility(
-    PHLWINDOWREF window,
-    SemmetyWindowVisibility mode
-) {
-	if (!window) { return false; }
-
-	switch (mode) {
-	case SemmetyWindowVisibility::Either: return true;
-	case SemmetyWindowVisibility::Visible: return isWindowVisible(window);
-	case SemmetyWindowVisibility::Hidden: return !isWindowVisible(window);
-	}
-
-	return false;
+void SemmetyWorkspaceWrapper::focusWindow(const SemmetyWindowRef& window) {
+	barRevision += 1;
+	::focusWindow(toHyprWindow(window));
 }
 
-PHLWINDOWREF
-SemmetyWorkspaceWrapper::getNextWindow(const GetNextWindowParams& params) {
-	auto windowMode = params.windowMode.value_or(SemmetyWindowMode::Either);
-	auto windowVisibility = params.windowVisibility.value_or(SemmetyWindowVisibility::Either);
-	auto backward = params.backward.value_or(false);
-
-	if (windows.size() == 0) { return {}; }
-
-	auto advanceIndex = [&](size_t currentIndex) -> size_t {
-		return (windows.size() + currentIndex + (backward ? -1 : 1)) % windows.size();
-	};
-
-	size_t index;
-	if (params.startFromIndex.has_value()) {
-		index = params.startFromIndex.value() % windows.size();
-	} else {
-		index = getLastFocusedWindowIndex() % windows.size();
-		index = advanceIndex(index);
-	}
-
-	for (size_t i = 0; i < windows.size(); i++) {
-		const auto window = windows[index];
-
-		if (windowMatchesMode(window, windowMode) && windowMatchesVisibility(window, windowVisibility))
-		{
-			return window;
-		}
-
-		index = advanceIndex(index);
-	}
-
-	return {};
+SemmetyWindowRef SemmetyWorkspaceWrapper::getFocusedWindow() const {
+	return toSemmetyWindow(Desktop::focusState()->window());
 }
 
-SP<SemmetyLeafFrame> SemmetyWorkspaceWrapper::getFrameForWindow(PHLWINDOWREF window) const {
-	const auto leafFrames = root->getLeafFrames();
-
-	for (const auto& frame: leafFrames) {
-		if (frame->getWindow() == window) { return frame; }
-	}
-
-	return nullptr;
+bool SemmetyWorkspaceWrapper::isActiveWorkspace() const {
+	return workspace == Desktop::focusState()->monitor()->m_activeWorkspace;
 }
 
-bool SemmetyWorkspaceWrapper::isWindowInFrame(PHLWINDOWREF window) const {
-	return !!getFrameForWindow(window);
+void SemmetyWorkspaceWrapper::raiseWindow(const SemmetyWindowRef& window) {
+	if (auto hyprWindow = toHyprWindow(window)) {
+		g_pCompositor->changeWindowZOrder(hyprWindow.lock(), true);
+	}
 }
 
-SP<SemmetyLeafFrame> SemmetyWorkspaceWrapper::getFocusedFrame() { return focused_frame; }
-
-void SemmetyWorkspaceWrapper::setFocusedFrame(SP<SemmetyFrame> frame) {
-	static int focusOrder = 0;
+void SemmetyWorkspaceWrapper::onFocusedFrameChanged(const SP<SemmetyLeafFrame>& previous) {
+	barRevision += 1;
 	static auto PACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.active_border");
-	static auto PINACTIVECOL = CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
+	static auto PINACTIVECOL =
+	    CConfigValue<Config::IComplexConfigValue>("general:col.inactive_border");
 	auto* const ACTIVECOL = (Config::CGradientValueData*) PACTIVECOL.ptr();
 	auto* const INACTIVECOL = (Config::CGradientValueData*) PINACTIVECOL.ptr();
 
-	if (!frame) { semmety_critical_error("Cannot set a null frame as focused"); }
-
-	if (focused_frame == frame) {
-		focusWindow(focused_frame->getWindow());
-		return;
-	}
-
-	focused_frame->setBorderColor(*INACTIVECOL);
-
-	focused_frame = frame->getLastFocussedLeaf();
-	focused_frame->focusOrder = ++focusOrder;
-	focused_frame->setBorderColor(*ACTIVECOL);
-	focusWindow(focused_frame->getWindow());
-}
-
-void SemmetyWorkspaceWrapper::activateWindow(PHLWINDOWREF window) {
-	if (!window) { return; }
-
-	if (window->m_isFloating) {
-		g_pCompositor->changeWindowZOrder(window.lock(), true);
-		return;
-	}
-
-	auto frameWithWindow = getFrameForWindow(window);
-	if (frameWithWindow) {
-		setFocusedFrame(frameWithWindow);
-		return;
-	}
-
-	// TODO: if window is not in workspace?
-	putWindowInFocussedFrame(window);
-}
-
-void SemmetyWorkspaceWrapper::jumpToWindow(PHLWINDOWREF window, int mode) {
-	if (!window) { return; }
-
-	if (mode == 0 || window->m_isFloating) {
-		activateWindow(window);
-		return;
-	}
-
-	auto frameWithWindow = getFrameForWindow(window);
-	if (frameWithWindow) {
-		activateWindow(window);
-		return;
+	if (auto frame = dynamicPointerCast<SemmetyHyprLeafFrame>(previous)) {
+		frame->setBorderColor(*INACTIVECOL);
 	}
 
-	auto frameHistory = getWindowFrameHistory(window);
-	for (auto it = frameHistory.rbegin(); it != frameHistory.rend(); ++it) {
-		const auto& pathString = *it;
-
-		auto frame = root->findRecursive([&pathString](const SP<SemmetyFrame>& f) {
-			return f && f->getPathString() == pathString;
-		});
-
-		if (!frame || !frame->isLeaf()) { continue; }
-
-		auto leafFrame = frame->asLeaf();
-		putWindowInFrame(window, leafFrame);
-		setFocusedFrame(leafFrame);
-
-		return;
-	}
-
-	activateWindow(window);
-}
-
-void SemmetyWorkspaceWrapper::updateFrameHistory(SP<SemmetyFrame> frame, PHLWINDOWREF window) {
-	const auto path = frame->getPathString();
-
-	// Update frame → windows mapping
-	auto& frameVec = frameHistoryMap[path];
-	frameVec.erase(std::remove(frameVec.begin(), frameVec.end(), window), frameVec.end());
-	frameVec.push_back(window);
-
-	// Update window → frames mapping (deduplicate)
-	auto& windowVec = windowFrameHistory[window];
-	windowVec.erase(std::remove(windowVec.begin(), windowVec.end(), path), windowVec.end());
-	windowVec.push_back(path);
-}
-
-std::vector<std::string> SemmetyWorkspaceWrapper::getWindowFrameHistory(PHLWINDOWREF window) const {
-	auto it = windowFrameHistory.find(window);
-	if (it == windowFrameHistory.end()) {
-		return {}; // Window not found or has no history
+	if (auto frame = dynamicPointerCast<SemmetyHyprLeafFrame>(getFocusedFrame())) {
+		frame->setBorderColor(*ACTIVECOL);
 	}
-	return it->second; // Return copy of history vector
-}
-
-bool isWindowFocussed(PHLWINDOWREF window) {
-	auto focused = Desktop::focusState()->window();
-	return focused && focused == window;
 }
 
 std::string SemmetyWorkspaceWrapper::getDebugString() {
-	std::string out = "";
-
 	if (!workspace) { return "workspace is empty"; }
 
-	out += format("workspace id + name '{}' '{}'\n", workspace->m_name, workspace->m_id);
-	out += "tiles:\n" + root->print(*this);
-
-	out += "\nwindows:\n";
-	for (const auto& window: windows) {
-		if (!window) {
-			out += "window is null";
-			continue;
-		}
-
-		auto winPtr = window.lock();
-		const auto ptrString = std::format("{:x}", (uintptr_t) window.get());
-		const auto focusString = isWindowFocussed(window) ? "focus" : "     ";
-		const auto hiddenString = isWindowVisible(window) ? "visible" : "hidden ";
-		const auto floatingString = isWindowFloating(window) ? "floating" : "tiled   ";
-		const auto frameString = isWindowInFrame(window) ? "inframe" : "       ";
-		const auto mappedString = winPtr->m_isMapped ? "mapped  " : "unmapped";
-		const auto actualHiddenString = winPtr->isHidden() ? "ishidden" : "        ";
-
-		// Check for mismatch: frame thinks window is visible but it's actually unmapped or hidden
-		std::string warning = "";
-		if (isWindowInFrame(window) && (!winPtr->m_isMapped || winPtr->isHidden())) {
-			warning = " [MISMATCH!]";
-		}
-
-		out += format(
-		    "{} {} {} {} {} {} {} {}{}\n",
-		    ptrString,
-		    focusString,
-		    hiddenString,
-		    floatingString,
-		    frameString,
-		    mappedString,
-		    actualHiddenString,
-		    winPtr->m_title,
-		    warning
-		);
-	}
-
-	// out += "\n";
-	// for (auto& [key, vec]: frameHistoryMap) {
-	// 	std::string ids = "";
-	// 	for (auto& window: vec) {
-	// 		ids = format("{} {}", ids, std::format("{:x}", (uintptr_t) window.get()));
-	// 	}
-
-	// 	out += format("{} {}\n", key, ids);
-	// }
-
-	return out;
+	return format("workspace id + name '{}' '{}'\n", workspace->m_name, workspace->m_id)
+	     + SemmetyWorkspace::getDebugString();
 }
 
 void SemmetyWorkspaceWrapper::printDebug() {
 	std::string debugStr = getDebugString();
 	std::istringstream stream(debugStr);
 	std::string line;
-	while (std::getline(stream, line)) { semmety_log(Log::ERR, "{}", line); }
-}
-
-json SemmetyWorkspaceWrapper::getWorkspaceWindowsJson() const {
-	json jsonWindows = json::array();
-	for (const auto& window: windows) {
-		jsonWindows.push_back(
-		    {{"address", std::format("{:x}", (uintptr_t) window.get())},
-		     {"urgent", window->m_isUrgent},
-		     {"title", window->fetchTitle()},
-		     {"appid", window->fetchClass()},
-		     {"focused", isWindowFocussed(window)},
-		     {"minimized", !isWindowVisible(window)}}
-		);
-	}
-
-	return jsonWindows;
-}
-
-void SemmetyWorkspaceWrapper::changeWindowOrder(bool prev) {
-	if (windows.size() < 2) { return; }
-
-	auto focusedWindow = Desktop::focusState()->window();
-	if (!focusedWindow) { return; }
-	auto it = findWindowIt(focusedWindow);
-	size_t index = std::distance(windows.begin(), it);
-	int offset = prev ? -1 : 1;
-	size_t n = windows.size();
-
-	size_t finalPos = (index + offset + n) % n;
-
-	auto window = windows[index];
-	windows.erase(windows.begin() + index);
-
-	windows.insert(windows.begin() + finalPos, window);
+	while (std::getline(stream, line)) { semmety_log(Dispatch, Log::INFO, "{}", line); }
 }
 
-std::vector<std::string> SemmetyWorkspaceWrapper::testInvariants() {
-	std::vector<std::string> errors;
-
-	// 1. Check that root is non-null.
-	if (!root) { errors.push_back("Invariant violation: root is null."); }
+std::vector<SemmetyBarWindowPtr> SemmetyWorkspaceWrapper::getBarWindows() {
+	const auto call = ++barWindowCalls;
 
-	// 2. Check that all window pointers in windows are non-null.
-	for (size_t i = 0; i < windows.size(); ++i) {
-		if (windows[i] == nullptr) {
-			errors.push_back(std::format("Invariant violation: workspace.windows[{}] is null.", i));
-		}
+	for (const auto& window: windows) {
+		if (!barWindowCache.contains(window)) { refreshBarWindow(window); }
 	}
 
-	// 3. Check that all windows in windows are unique.
-	std::unordered_set<PHLWINDOWREF> workspaceWindowSet;
-	for (size_t i = 0; i < windows.size(); ++i) {
-		PHLWINDOWREF w = windows[i];
-		if (!w) { continue; }
-
-		if (workspaceWindowSet.find(w) != workspaceWindowSet.end()) {
-			errors.push_back(
-			    std::format(
-			        "Invariant violation: Duplicate window pointer found in workspace.windows at index "
-			        "{}.",
-			        i
-			    )
-			);
-		} else {
-			workspaceWindowSet.insert(w);
+	// one walk over the leaves rather than a tree search per window
+	if (root) {
+		for (const auto& leaf: root->getLeafFrames()) {
+			const auto it = barWindowCache.find(leaf->getWindow());
+			if (it != barWindowCache.end()) { it->second.framedIn = call; }
 		}
 	}
 
-	// 4. Traverse the frame tree starting at root to perform several frame-related checks.
-	// We'll collect all frames, and also check that each frame is unique.
-	std::vector<SP<SemmetyFrame>> allFrames;
-	std::unordered_set<SemmetyFrame*> frameSet;
-
-	if (root) { traverseFramesForInvariants(root, errors, frameSet, allFrames); }
-
-	// 5. Check that in leaf frames:
-	// - window pointer is non-null (if the frame is not empty),
-	// - windows in frames are unique,
-	// - and that windows in frames are not minimized/hidden.
-	std::unordered_set<PHLWINDOWREF> frameWindowSet;
-	for (const auto& frame: allFrames) {
-		if (!frame->isLeaf()) { continue; }
-
-		auto leafFrame = frame->asLeaf();
-		if (leafFrame->isEmpty()) { continue; }
-
-		auto window = leafFrame->getWindow();
-		if (window == nullptr) {
-			errors.push_back("Invariant violation: Leaf frame contains a null window pointer.");
-			continue;
-		}
+	std::vector<SemmetyBarWindowPtr> barWindows;
+	barWindows.reserve(windows.size());
 
-		// Check uniqueness of windows in frames.
-		if (frameWindowSet.find(window) != frameWindowSet.end()) {
-			errors.push_back("Invariant violation: Duplicate window pointer found in frames.");
-		} else {
-			frameWindowSet.insert(window);
-		}
+	const auto focusedWindow = getFocusedWindow();
 
-		// Check that window visibility state matches actual hidden state
-		// For tiled windows in frames, isWindowVisible returns true if in frame
-		// But the actual window might still be hidden
-		auto winPtr = window.lock();
-		if (winPtr && isWindowInFrame(window) && (winPtr->isHidden() || !winPtr->m_isMapped)) {
-			errors.push_back(
-			    std::format(
-			        "Invariant violation: Window in frame is actually hidden or unmapped. Title: '{}'",
-			        winPtr->m_title
-			    )
-			);
+	for (const auto& window: windows) {
+		auto& entry = barWindowCache.at(window);
+		entry.seenIn = call;
+
+		// same as isWindowFocussed() and isWindowVisible()
+		const auto hyprWindow = toHyprWindow(window);
+		const bool urgent = hyprWindow && hyprWindow->m_isUrgent;
+		const bool focused = focusedWindow && focusedWindow == window;
+		const bool minimized = window->isFloating() ? window->isHidden() : entry.framedIn != call;
+
+		const auto& cached = *entry.window;
+		if (cached.urgent != urgent || cached.focused != focused || cached.minimized != minimized
+		    || cached.jsonFragment.empty()) {
+			auto barWindow = cached;
+			barWindow.urgent = urgent;
+			barWindow.focused = focused;
+			barWindow.minimized = minimized;
+			barWindow.jsonFragment = barWindowJsonFragment(barWindow);
+			entry.window = std::move(barWindow);
 		}
-	}
 
-	// 6. There should be no empty leaf frames if there are minimized windows.
-	// bool hasMinimizedWindow = false;
-	// for (const auto& w: windows) {
-	// 	if (isWindowMinimized(w)) {
-	// 		hasMinimizedWindow = true;
-	// 		break;
-	// 	}
-	// }
-
-	// if (hasMinimizedWindow) {
-	// 	for (const auto& frame: allFrames) {
-	// 		if (!frame->isLeaf()) {
-	// 			continue;
-	// 		}
-
-	// 		auto leafFrame = frame->asLeaf();
-	// 		if (leafFrame->isEmpty()) {
-	// 			errors.push_back("Invariant violation: An empty leaf frame exists despite the presence "
-	// 			                 "of minimized windows.");
-	// 		}
-	// 	}
-	// }
-
-	// // 7. Windows not assigned to any frame should be hidden/minimized.
-	// // For every window in windows that does not appear in a frame, check that it is
-	// // minimized.
-	// for (const auto& w: windows) {
-	// 	if (isWindowMinimized(w) && !w->isHidden()) {
-	// 		errors.push_back(std::format(
-	// 		    "Invariant violation: Window not assigned to any frame is not hidden. {}",
-	// 		    w->fetchTitle()
-	// 		));
-	// 	}
-	// }
-
-	// 8. Verify all frame paths are correct by comparing cached vs computed
-	if (root) {
-		std::function<void(SP<SemmetyFrame>)> verifyPaths = [&](SP<SemmetyFrame> frame) {
-			if (!frame) { return; }
-
-			const auto cachedPath = frame->getPathString();
-			const auto computedPath = getFramePath(frame, root);
-
-			if (cachedPath != computedPath) {
-				errors.push_back(format(
-				    "Invariant violation: Frame path mismatch. Cached='{}', Computed='{}'",
-				    cachedPath,
-				    computedPath
-				));
-			}
-
-			if (frame->isSplit()) {
-				const auto& children = frame->asSplit()->getChildren();
-				verifyPaths(children.first);
-				verifyPaths(children.second);
-			}
-		};
-
-		verifyPaths(root);
+		barWindows.push_back(entry.window);
 	}
 
-	// 9. Verify windowFrameHistory consistency with frameHistoryMap
-	for (const auto& [window, framePaths]: windowFrameHistory) {
-		for (const auto& framePath: framePaths) {
-			// Verify that if window is in windowFrameHistory[W] with frame F,
-			// then window is also in frameHistoryMap[F]
-			auto frameIt = frameHistoryMap.find(framePath);
-			if (frameIt == frameHistoryMap.end()) {
-				errors.push_back(format(
-				    "Invariant violation: Window in windowFrameHistory claims to be in frame '{}' but "
-				    "frame has no history",
-				    framePath
-				));
-				continue;
-			}
-
-			const auto& windowsInFrame = frameIt->second;
-			if (std::find(windowsInFrame.begin(), windowsInFrame.end(), window) == windowsInFrame.end()) {
-				errors.push_back(format(
-				    "Invariant violation: Window in windowFrameHistory['{}'] but not in "
-				    "frameHistoryMap['{}']",
-				    framePath,
-				    framePath
-				));
-			}
-		}
-	}
+	std::erase_if(barWindowCache, [&](const auto& entry) { return entry.second.seenIn != call; });
 
-	return errors;
+	return barWindows;
 }
 
-const SP<SemmetyFrame>& SemmetyWorkspaceWrapper::getRoot() const { return root; }
-
-void SemmetyWorkspaceWrapper::setRootGeometry(const CBox& geometry) { root->geometry = geometry; }
+SemmetyBarFocus SemmetyWorkspaceWrapper::getBarFocus() const {
+	const auto focusedWindow = getFocusedWindow();
 
-void SemmetyWorkspaceWrapper::traverseFramesForInvariants(
-    const SP<SemmetyFrame>& frame,
-    std::vector<std::string>& errors,
-    std::unordered_set<SemmetyFrame*>& frameSet,
-    std::vector<SP<SemmetyFrame>>& allFrames
-) {
-	if (!frame) {
-		errors.push_back("Invariant violation: null frame encountered in frame tree.");
-		return;
-	}
+	return {
+	    .window = focusedWindow ? std::format("{:x}", focusedWindow->id()) : "",
+	    .frame = focused_frame ? focused_frame->getPathString() : "",
+	    .monitor = workspace->m_monitor ? workspace->m_monitor->m_name : "",
+	    .workspace = (int) workspace->m_id,
+	};
+}
 
-	// Check for duplicate frames.
-	if (frameSet.find(frame.get()) != frameSet.end()) {
-		errors.push_back("Invariant violation: Duplicate frame encountered in frame tree.");
-	} else {
-		frameSet.insert(frame.get());
-		allFrames.push_back(frame);
+std::vector<SemmetyBarFrame> SemmetyWorkspaceWrapper::getBarFrames() const {
+	std::vector<SemmetyBarFrame> barFrames;
+	if (!root) { return barFrames; }
+
+	for (const auto& leaf: root->getLeafFrames()) {
+		const auto window = leaf->getWindow();
+		barFrames.push_back({
+		    .path = leaf->getPathString(),
+		    .window = window ? std::format("{:x}", window->id()) : "",
+		    .x = (int) leaf->geometry.x,
+		    .y = (int) leaf->geometry.y,
+		    .width = (int) leaf->geometry.width,
+		    .height = (int) leaf->geometry.height,
+		    .focused = leaf == focused_frame,
+		});
 	}
 
-	if (!frame->isSplit()) { return; }
-
-	// If the frame is a split frame, we need to check:
-	// - both children are valid (non-null)
-	// - then traverse both children.
-	auto splitFrame = frame->asSplit();
-	const auto& children = splitFrame->getChildren();
-	if (!children.first) {
-		errors.push_back("Invariant violation: Split frame has a null first child.");
-	}
-	if (!children.second) {
-		errors.push_back("Invariant violation: Split frame has a null second child.");
-	}
-	if (children.first) { traverseFramesForInvariants(children.first, errors, frameSet, allFrames); }
-	if (children.second) {
-		traverseFramesForInvariants(children.second, errors, frameSet, allFrames);
-	}
+	return barFrames;
 }
+
@@ -1,92 +1,62 @@
 #pragma once
 
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 
 #include <hyprland/src/plugins/PluginAPI.hpp>
 #include <hyprutils/memory/SharedPtr.hpp>
 
+#include "SemmetyBarState.hpp"
 #include "SemmetyFrame.hpp"
-#include "json.hpp"
+#include "SemmetyWorkspace.hpp"
 #include "src/desktop/DesktopTypes.hpp"
-using json = nlohmann::json;
 
 class SemmetyLayout;
 
-enum class SemmetyWindowMode {
-	Tiled,
-	Floating,
-	Either,
-};
-
-enum class SemmetyWindowVisibility {
-	Visible,
-	Hidden,
-	Either,
-};
-
-struct GetNextWindowParams {
-	std::optional<bool> backward;
-	std::optional<size_t> startFromIndex;
-	std::optional<SemmetyWindowMode> windowMode;
-	std::optional<SemmetyWindowVisibility> windowVisibility;
-};
-
-const GetNextWindowParams nextTiledWindowParams = {
-    .windowMode = SemmetyWindowMode::Tiled,
-    .windowVisibility = SemmetyWindowVisibility::Hidden,
-};
-
-class SemmetyWorkspaceWrapper {
+// A Hyprland workspace: the layout core's workspace plus what the bar and rendering need.
+class SemmetyWorkspaceWrapper: public SemmetyWorkspace {
 public:
 	SemmetyWorkspaceWrapper(PHLWORKSPACEREF w, SemmetyLayout&);
 	PHLWORKSPACEREF workspace;
 	SemmetyLayout& layout;
-	std::vector<PHLWINDOWREF> windows;
-	std::unordered_map<std::string, std::vector<PHLWINDOWREF>> frameHistoryMap;
-	std::unordered_map<PHLWINDOWREF, std::vector<std::string>> windowFrameHistory;
-
-	size_t getLastFocusedWindowIndex();
-
-	PHLWINDOWREF getNextWindow(const GetNextWindowParams& params = {});
-
-	void addWindow(PHLWINDOWREF w);
-	void removeWindow(PHLWINDOWREF window);
-	SP<SemmetyLeafFrame> getFocusedFrame();
-	void setFocusedFrame(SP<SemmetyFrame> frame);
-	SP<SemmetyLeafFrame> getFrameForWindow(PHLWINDOWREF window) const;
-	void advanceFrameWithWindow(PHLWINDOWREF window, bool focusNextWindow);
-	std::vector<PHLWINDOWREF>::iterator findWindowIt(PHLWINDOWREF window);
-	bool isWindowInFrame(PHLWINDOWREF window) const;
-	bool isWindowVisible(PHLWINDOWREF window) const;
-	void putWindowInFocussedFrame(PHLWINDOWREF window);
-	void setWindowTiled(PHLWINDOWREF window, bool isTiled);
+	// Windows that raised the urgent event. Hyprland clears the flag on focus without an event, so
+	// pruneUrgentWindows() drops the ones that are no longer urgent from the urgent and focus
+	// listeners.
+	std::vector<PHLWINDOWREF> urgentWindows;
+	// What the bar shows for each window in `windows`. Title and class are refreshed on the title
+	// event, the flags are compared on every getBarWindows(), and a record (with its JSON fragment)
+	// is only rebuilt when something changed. getBarWindows() drops the entries of windows that left
+	// without going through removeWindow().
+	struct SBarWindowEntry {
+		SemmetyBarWindowPtr window;
+		uint64_t framedIn = 0; // the getBarWindows() call whose leaf walk found the window
+		uint64_t seenIn = 0;   // the getBarWindows() call that last found it in `windows`
+	};
+	std::unordered_map<SemmetyWindowRef, SBarWindowEntry> barWindowCache;
+	uint64_t barWindowCalls = 0;
+	// Bumped by the hooks that can change what getBarWindows() returns (windows added, removed,
+	// retitled, marked urgent, placed or focused), so the window lists of monitors whose workspace
+	// isn't focused can be reused until it moves.
+	uint64_t barRevision = 0;
+
+	void addWindow(const SemmetyWindowRef& window) override;
+	void removeWindow(const SemmetyWindowRef& window) override;
+	void markWindowUrgent(PHLWINDOWREF window);
+	void pruneUrgentWindows();
+	bool hasUrgentWindow() const;
+	void refreshBarWindow(const SemmetyWindowRef& window);
 	void printDebug();
-	std::string getDebugString();
-	void changeWindowOrder(bool prev);
-	json getWorkspaceWindowsJson() const;
-	void activateWindow(PHLWINDOWREF window);
-	void jumpToWindow(PHLWINDOWREF window, int mode);
-	SP<SemmetyLeafFrame> getLargestEmptyFrame();
-	void updateFrameHistory(SP<SemmetyFrame> frame, PHLWINDOWREF window);
-	std::vector<std::string> getWindowFrameHistory(PHLWINDOWREF window) const;
-	bool windowMatchesVisibility(PHLWINDOWREF window, SemmetyWindowVisibility mode);
-	PHLWINDOWREF getNextWindowForFrame(SP<SemmetyLeafFrame> frame);
-	void putWindowInFrame(PHLWINDOWREF window, SP<SemmetyLeafFrame> frame);
-	std::vector<std::string> testInvariants();
-	const SP<SemmetyFrame>& getRoot() const;
-	void setRootGeometry(const CBox& geometry);
-
-private:
-	SP<SemmetyFrame> root;
-	SP<SemmetyLeafFrame> focused_frame;
-
-	void traverseFramesForInvariants(
-	    const SP<SemmetyFrame>& frame,
-	    std::vector<std::string>& errors,
-	    std::unordered_set<SemmetyFrame*>& frameSet,
-	    std::vector<SP<SemmetyFrame>>& allFrames
-	);
-
-	friend void replaceNode(SP<SemmetyFrame>, SP<SemmetyFrame>, SemmetyWorkspaceWrapper&);
+	std::string getDebugString() override;
+	std::vector<SemmetyBarWindowPtr> getBarWindows();
+	SemmetyBarFocus getBarFocus() const;
+	std::vector<SemmetyBarFrame> getBarFrames() const;
+
+	SP<SemmetyLeafFrame> createLeafFrame() override;
+	void placeWindow(SemmetyLeafFrame& frame) override;
+	void focusWindow(const SemmetyWindowRef& window) override;
+	SemmetyWindowRef getFocusedWindow() const override;
+	bool isActiveWorkspace() const override;
+	void raiseWindow(const SemmetyWindowRef& window) override;
+	void onFocusedFrameChanged(const SP<SemmetyLeafFrame>& previous) override;
 };
@@ -4,6 +4,7 @@
 // clang-format on
 
 #include "dispatchers.hpp"
+#include <fstream>
 #include <optional>
 
 using Hyprutils::String::CVarList;
@@ -23,8 +24,12 @@ using Hyprutils::String::CVarList;
 #include <hyprutils/memory/SharedPtr.hpp>
 #include <hyprutils/string/String.hpp>
 
+#include "SemmetyFlightRecorder.hpp"
 #include "SemmetyFrame.hpp"
 #include "SemmetyFrameUtils.hpp"
+#include "SemmetyLayoutDispatchers.hpp"
+#include "SemmetySpans.hpp"
+#include "SemmetyWindowHypr.hpp"
 #include "SemmetyWorkspaceWrapper.hpp"
 #include "dispatchers.hpp"
 #include "globals.hpp"
@@ -38,106 +43,53 @@ dispatchDebug(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame>, CVarList
 	if (workspace.workspace.lock() == nullptr) { return "Workspace is null"; }
 
 	workspace.printDebug();
-	return std::nullopt;
-}
-
-std::optional<std::string>
-dispatchSplit(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame> focussedFrame, CVarList) {
-	auto firstChild = focussedFrame;
-
-	auto next = workspace.getNextWindow(nextTiledWindowParams);
-	if (next) {
-		semmety_log(
-		    Log::ERR,
-		    "Split found next window {} {}",
-		    next->fetchTitle(),
-		    workspace.isWindowInFrame(next)
-		);
-	}
-	auto secondChild = SemmetyLeafFrame::create({});
-	auto newSplit = SemmetySplitFrame::create(firstChild, secondChild, focussedFrame->geometry);
 
-	replaceNode(focussedFrame, newSplit, workspace);
-	workspace.setFocusedFrame(secondChild);
+	const auto& barStats = getBarUpdateStats();
+	semmety_log(
+	    Dispatch,
+	    Log::INFO,
+	    "bar updates: {} requested, {} coalesced, {} published",
+	    barStats.requested,
+	    barStats.coalesced,
+	    barStats.published
+	);
 
 	return std::nullopt;
 }
 
-std::optional<std::string> dispatchRemove(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyLeafFrame> focussedFrame,
-    CVarList args
-) {
-	auto parent = findParent(focussedFrame, workspace);
-	if (!parent) { return "Frame has no parent, cannot remove the root frame!"; }
-
-	if (args[0] == "sibling") {
-		replaceNode(parent, focussedFrame, workspace);
-	} else {
-		auto remainingSibling = parent->getOtherChild(focussedFrame);
-		replaceNode(parent, remainingSibling, workspace);
-		workspace.setFocusedFrame(remainingSibling);
-	}
-
-	return std::nullopt;
-}
-
-std::optional<std::string> dispatchCycle(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyLeafFrame> focussedFrame,
-    CVarList args
-) {
-	auto params = nextTiledWindowParams;
-	PHLWINDOWREF window;
-	if (args[0] == "prev") {
-		params.backward = true;
-		window = workspace.getNextWindow(params);
-	} else {
-		window = workspace.getNextWindow(params);
-	}
+std::optional<std::string>
+dispatchDumpSpans(SemmetyWorkspaceWrapper&, SP<SemmetyLeafFrame>, CVarList args) {
+	if (!g_semmetySpans.enabled()) { return "Span recording is off, set plugin:semmety:span_buffer"; }
 
-	if (!window) { return std::nullopt; }
+	const auto path = args.size() > 0 && !args[0].empty()
+	                    ? args[0]
+	                    : g_pCompositor->m_instancePath + "/semmety-spans.json";
 
-	workspace.putWindowInFocussedFrame(window);
+	if (!g_semmetySpans.dump(path)) { return std::format("Failed to write spans to {}", path); }
 
+	semmety_log(Dispatch, Log::INFO, "wrote spans to {}", path);
 	return std::nullopt;
 }
 
-std::optional<std::string> dispatchFocus(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyLeafFrame> focussedFrame,
-    CVarList args
-) {
-	const auto direction = directionFromString(args[0]);
-	if (!direction.has_value()) {
-		// TODO: return error
-		return std::nullopt;
-	}
+std::optional<std::string>
+dispatchDumpFlight(SemmetyWorkspaceWrapper&, SP<SemmetyLeafFrame>, CVarList args) {
+	const auto path = args.size() > 0 && !args[0].empty()
+	                    ? args[0]
+	                    : g_pCompositor->m_instancePath + "/semmety-flight.txt";
 
-	const auto neighbor = getNeighborByDirection(workspace, focussedFrame, direction.value());
-	if (!neighbor) { return std::nullopt; }
+	std::ofstream file(path, std::ios::trunc);
+	file << g_semmetyFlight.decode();
+	if (!file.good()) { return std::format("Failed to write the flight recorder to {}", path); }
 
-	workspace.setFocusedFrame(neighbor);
+	semmety_log(Dispatch, Log::INFO, "wrote the flight recorder to {}", path);
 	return std::nullopt;
 }
 
-std::optional<std::string> dispatchSwap(
-    SemmetyWorkspaceWrapper& workspace,
-    SP<SemmetyLeafFrame> focussedFrame,
-    CVarList args
-) {
-	const auto direction = directionFromString(args[0]);
-	if (!direction.has_value()) {
-		return format("Failed to pares direction from argument string '{}'", args[0]);
-	}
-
-	const auto neighbor = getNeighborByDirection(workspace, focussedFrame, direction.value());
-	if (!neighbor) { return std::nullopt; }
-
-	focussedFrame->swapContents(workspace, neighbor);
-	workspace.setFocusedFrame(neighbor);
+std::optional<std::string>
+dispatchLogLevel(SemmetyWorkspaceWrapper&, SP<SemmetyLeafFrame>, CVarList args) {
+	if (args.size() == 0 || args[0].empty()) { return "No log levels provided"; }
 
-	return std::nullopt;
+	return setSemmetyLogLevels(args.join(" "));
 }
 
 std::optional<std::string>
@@ -165,17 +117,7 @@ dispatchJump(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame>, CVarList
 	}
 
 	auto targetWorkspace = workspace_for_window(window);
-	targetWorkspace->jumpToWindow(window, mode);
-
-	return std::nullopt;
-}
-
-std::optional<std::string>
-dispatchChangeWindowOrder(SemmetyWorkspaceWrapper& workspace, SP<SemmetyLeafFrame>, CVarList args) {
-	if (args.size() == 0) { return "Expected 'prev' or 'next' as argument"; }
-
-	const bool prev = args[0] == "prev";
-	workspace.changeWindowOrder(prev);
+	targetWorkspace->jumpToWindow(toSemmetyWindow(window), mode);
 
 	return std::nullopt;
 }
@@ -188,13 +130,30 @@ dispatchUpdateBar(SemmetyWorkspaceWrapper&, SP<SemmetyLeafFrame>, CVarList) {
 using DispatchFunc = std::function<
     std::optional<std::string>(SemmetyWorkspaceWrapper&, SP<SemmetyLeafFrame>, CVarList)>;
 
-SDispatchResult dispatchWrapper(const std::string& arg, const DispatchFunc& action) {
+SDispatchResult
+dispatchWrapper(const std::string& name, const std::string& arg, const DispatchFunc& action) {
 	// TODO? Check that the layout pointer is valid?
 	auto* workspace = workspace_for_action(true);
 	if (!workspace) { return {.passEvent = false, .success = false, .error = ""}; }
 
+	if (SemmetyLayout::trace.isOpen()) {
+		SemmetyLayout::trace.write({
+		    .event = SemmetyTraceEvent::Dispatch,
+		    .workspace = workspace->workspace ? workspace->workspace->m_id : WORKSPACE_INVALID,
+		    .name = name,
+		    .args = arg,
+		});
+	}
+
 	auto args = CVarList(arg);
 	auto focused = workspace->getFocusedFrame();
+
+	const auto focusedWindow = workspace->getFocusedWindow();
+	SemmetyFlightEntry::note(
+	    workspace->workspace ? workspace->workspace->m_id : 0,
+	    (uintptr_t) focused.get(),
+	    focusedWindow ? focusedWindow->id() : 0
+	);
 	if (auto err = action(*workspace, focused, args)) {
 		return {.passEvent = false, .success = false, .error = *err};
 	}
@@ -207,7 +166,7 @@ SDispatchResult dispatchWrapper(const std::string& arg, const DispatchFunc& acti
 void registerSemmetyDispatcher(const std::string& name, const DispatchFunc& func) {
 	HyprlandAPI::addDispatcherV2(PHANDLE, "semmety:" + name, [func, name](const std::string& arg) {
 		return g_SemmetyLayout->entryWrapper("semmety:" + name, [&]() {
-			return dispatchWrapper(arg, func);
+			return dispatchWrapper(name, arg, func);
 		});
 	});
 }
@@ -223,4 +182,7 @@ void registerDispatchers() {
 	registerSemmetyDispatcher("changewindoworder", dispatchChangeWindowOrder);
 	registerSemmetyDispatcher("updatebar", dispatchUpdateBar);
 	registerSemmetyDispatcher("debug", dispatchDebug);
+	registerSemmetyDispatcher("dumpspans", dispatchDumpSpans);
+	registerSemmetyDispatcher("dumpflight", dispatchDumpFlight);
+	registerSemmetyDispatcher("loglevel", dispatchLogLevel);
 }
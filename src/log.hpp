@@ -1,30 +1,75 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <string_view>
+
 #include <hyprland/src/debug/log/Logger.hpp>
 
+#include "SemmetyError.hpp"
+
 // declared in utils.cpp
-std::string getSemmetyIndent();
 std::string getInitialDebugString();
 std::string getCurrentDebugString();
 std::string getCallStackAsString();
+// Logs a critical error with the call stack and the layout state, see g_semmetyCriticalErrorHook.
+void logCriticalError(const std::string& msg);
+// Sets category levels from a spec like "info" or "layout:trace ipc:warn", where each category is
+// dispatch, layout, ipc, render or all and each level is trace, info, warn, err, crit or off.
+// Returns the first entry it didn't understand, after applying the ones before it.
+std::optional<std::string> setSemmetyLogLevels(std::string_view spec);
 
-template <typename... Args>
-void semmety_log(Hyprutils::CLI::eLogLevel level, std::format_string<Args...> fmt, Args&&... args) {
-	auto msg = std::vformat(fmt.get(), std::make_format_args(args...));
-	std::string indent = getSemmetyIndent();
-	Log::logger->log(level, "[semmety] {}{}", indent, msg);
+enum class eSemmetyLogCategory : uint8_t {
+	Dispatch,
+	Layout,
+	Ipc,
+	Render,
+	Count,
+};
+
+// The lowest level logged per category. Read on the compositor and I/O threads.
+inline std::array<std::atomic<uint8_t>, (size_t) eSemmetyLogCategory::Count> g_semmetyLogLevels = {
+    Log::INFO,
+    Log::INFO,
+    Log::INFO,
+    Log::INFO,
+};
+
+// Nesting of entryWrapper() calls on this thread, indents the log lines.
+inline thread_local int t_semmetyLogIndent = 0;
+
+inline bool semmetyLogEnabled(eSemmetyLogCategory category, Hyprutils::CLI::eLogLevel level) {
+	return level >= g_semmetyLogLevels[(size_t) category].load(std::memory_order_relaxed);
 }
 
 template <typename... Args>
-[[noreturn]] void semmety_critical_error(std::format_string<Args...> fmt, Args&&... args) {
+void semmetyLogWrite(
+    Hyprutils::CLI::eLogLevel level,
+    std::format_string<Args...> fmt,
+    Args&&... args
+) {
 	auto msg = std::vformat(fmt.get(), std::make_format_args(args...));
+	Log::logger->log(level, "[semmety] {}{}", std::string(t_semmetyLogIndent * 4, ' '), msg);
+}
 
-	std::string out = "";
-	out += "[semmety] " + msg;
-	out += "\ncallstack:\n" + getCallStackAsString();
-	out += "\ninitial state:\n" + getInitialDebugString();
-	out += "\ncurrent state:\n" + getCurrentDebugString();
+// semmety_log(Layout, Log::INFO, "format", args...). The level check comes first, so a filtered
+// message costs one relaxed load and its arguments are never evaluated.
+#define semmety_log(category, level, ...)                                                          \
+	do {                                                                                           \
+		if (semmetyLogEnabled(eSemmetyLogCategory::category, level)) {                             \
+			semmetyLogWrite(level, __VA_ARGS__);                                                   \
+		}                                                                                          \
+	} while (0)
 
-	Log::logger->log(Log::CRIT, "{}", out);
-	throw std::runtime_error(out);
-}
+// Trace level logs, compiled out entirely with -Dstrip_trace_logs.
+#ifdef SEMMETY_STRIP_TRACE_LOGS
+#define semmety_trace(category, ...)                                                               \
+	do {                                                                                           \
+	} while (0)
+#else
+#define semmety_trace(category, ...) semmety_log(category, Log::TRACE, __VA_ARGS__)
+#endif
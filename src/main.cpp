@@ -9,6 +9,7 @@
 #include "dispatchers.hpp"
 #include "globals.hpp"
 #include "src/log.hpp"
+#include "utils.hpp"
 
 APICALL EXPORT std::string PLUGIN_API_VERSION() { return HYPRLAND_API_VERSION; }
 
@@ -17,7 +18,7 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 
 	const std::string HASH = __hyprland_api_get_hash();
 
-	Log::logger->log(Log::ERR, "[semmety] new!");
+	semmety_log(Layout, Log::INFO, "new!");
 	HyprlandAPI::addNotification(
 	    PHANDLE,
 	    std::format("[semmety] Loaded (Hyprland API: {})", HASH).c_str(),
@@ -25,7 +26,8 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 	    3000
 	);
 
-	g_SemmetyEventManager = makeUnique<SemmetyEventManager>();
+	g_semmetyCriticalErrorHook = logCriticalError;
+	g_SemmetyEventManager = makeUnique<SemmetyEventManager>(updateBar);
 	HyprlandAPI::addTiledAlgo(PHANDLE, "semmety", &typeid(SemmetyLayout), []() -> UP<Layout::ITiledAlgorithm> {
 		// One instance is created per space. The constructor registers it (and keeps g_SemmetyLayout
 		// valid); onEnabled() performs the process-wide setup only once.
@@ -34,9 +36,40 @@ APICALL EXPORT PLUGIN_DESCRIPTION_INFO PLUGIN_INIT(HANDLE handle) {
 		return algo;
 	});
 
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:bar_title_interval", Hyprlang::INT {250});
+	// "fixed" sends workspaces 1 to 8 with placeholders for missing ones, "all" every workspace
+	// semmety manages, sorted by id.
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:bar_workspaces", Hyprlang::STRING {"fixed"});
+	// Records every entry point to this file from plugin load until unload, for semmety-replay.
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:trace_file", Hyprlang::STRING {""});
+	// Number of timed spans kept for semmety:dumpspans, 0 leaves span recording off.
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:span_buffer", Hyprlang::INT {0});
+	// Log levels at load, like "warn layout:trace", see setSemmetyLogLevels(). semmety:loglevel
+	// takes the same spec at runtime.
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:log_levels", Hyprlang::STRING {""});
+	// Hardware counters per entry point for the socket's perf command, read at load.
+	HyprlandAPI::addConfigValue(PHANDLE, "plugin:semmety:perf_counters", Hyprlang::INT {0});
+
 	registerDispatchers();
 	HyprlandAPI::reloadConfig();
 
+	static const auto traceFile = ConfigValue<Hyprlang::STRING>("plugin:semmety:trace_file");
+	if (std::string path = *traceFile; !path.empty()) { SemmetyLayout::startTrace(path); }
+
+	static const auto logLevels = ConfigValue<Hyprlang::STRING>("plugin:semmety:log_levels");
+	if (const auto error = setSemmetyLogLevels(*logLevels)) {
+		semmety_log(Layout, Log::ERR, "plugin:semmety:log_levels: {}", *error);
+	}
+
+	static const auto spanBuffer = ConfigValue<Hyprlang::INT>("plugin:semmety:span_buffer");
+	if (*spanBuffer > 0) {
+		g_semmetySpans.nameThread("compositor");
+		g_semmetySpans.start(*spanBuffer);
+	}
+
+	static const auto perfCounters = ConfigValue<Hyprlang::INT>("plugin:semmety:perf_counters");
+	if (*perfCounters != 0) { g_semmetyPerf.start(); }
+
 	return {"semmety", "Semi automatic tiling window manager", "jmoggr", "0.4"};
 }
 
@@ -45,4 +78,7 @@ APICALL EXPORT void PLUGIN_EXIT() {
 		g_SemmetyLayout->onDisabled();
 		g_SemmetyLayout = nullptr;
 	}
+
+	g_semmetyCriticalErrorHook = nullptr;
+	g_semmetyPerf.stop();
 }
@@ -1,7 +1,10 @@
 #include "utils.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 
 #include <cxxabi.h>
 #include <execinfo.h>
@@ -19,13 +22,12 @@
 #include <hyprland/src/render/pass/BorderPassElement.hpp>
 #include <hyprlang.hpp>
 
+#include "SemmetyFlightRecorder.hpp"
+#include "SemmetySpans.hpp"
 #include "globals.hpp"
 #include "log.hpp"
 #include "src/SemmetyEventManager.hpp"
 
-std::string getSemmetyIndent() {
-	return g_SemmetyLayout ? std::string(g_SemmetyLayout->entryCount * 4, ' ') : "";
-}
 std::string getInitialDebugString() {
 	return g_SemmetyLayout ? g_SemmetyLayout->debugStringOnEntry : "[not initialized]";
 }
@@ -33,6 +35,60 @@ std::string getCurrentDebugString() {
 	return g_SemmetyLayout ? g_SemmetyLayout->getDebugString() : "[not initialized]";
 }
 
+void logCriticalError(const std::string& msg) {
+	std::string out = "";
+	out += "[semmety] " + msg;
+	out += "\ncallstack:\n" + getCallStackAsString();
+	out += "\ninitial state:\n" + getInitialDebugString();
+	out += "\ncurrent state:\n" + getCurrentDebugString();
+	out += "\nrecent entry points:\n" + g_semmetyFlight.decode();
+
+	Log::logger->log(Log::CRIT, "{}", out);
+}
+
+static std::optional<uint8_t> logLevelFromString(std::string_view name) {
+	if (name == "trace") { return Log::TRACE; }
+	if (name == "info") { return Log::INFO; }
+	if (name == "warn") { return Log::WARN; }
+	if (name == "err") { return Log::ERR; }
+	if (name == "crit") { return Log::CRIT; }
+	if (name == "off") { return UINT8_MAX; }
+	return std::nullopt;
+}
+
+std::optional<std::string> setSemmetyLogLevels(std::string_view spec) {
+	static const std::unordered_map<std::string_view, eSemmetyLogCategory> categories = {
+	    {"dispatch", eSemmetyLogCategory::Dispatch},
+	    {"layout", eSemmetyLogCategory::Layout},
+	    {"ipc", eSemmetyLogCategory::Ipc},
+	    {"render", eSemmetyLogCategory::Render},
+	};
+
+	while (!spec.empty()) {
+		const auto end = std::min(spec.find_first_of(" ,"), spec.size());
+		const auto entry = spec.substr(0, end);
+		spec.remove_prefix(std::min(end + 1, spec.size()));
+		if (entry.empty()) { continue; }
+
+		const auto colon = entry.find(':');
+		const auto categoryName = colon == std::string_view::npos ? "all" : entry.substr(0, colon);
+		const auto level = logLevelFromString(
+		    colon == std::string_view::npos ? entry : entry.substr(colon + 1)
+		);
+		if (!level) { return std::format("unknown log level in '{}'", entry); }
+
+		if (categoryName == "all") {
+			for (auto& categoryLevel: g_semmetyLogLevels) { categoryLevel = *level; }
+		} else if (const auto it = categories.find(categoryName); it != categories.end()) {
+			g_semmetyLogLevels[(size_t) it->second] = *level;
+		} else {
+			return std::format("unknown log category in '{}'", entry);
+		}
+	}
+
+	return std::nullopt;
+}
+
 std::optional<size_t> getFocusHistoryIndex(PHLWINDOW wnd) {
 	// CCompositor::m_windowFocusHistory was removed in 0.55; focus history now lives in the
 	// dedicated window tracker. fullHistory() is ordered old -> new (back() is the most recently
@@ -46,44 +102,6 @@ std::optional<size_t> getFocusHistoryIndex(PHLWINDOW wnd) {
 	return std::nullopt;
 }
 
-std::string getGeometryString(const CBox geometry) {
-	return std::format(
-	    "{}, {}, {}, {}",
-	    geometry.pos().x,
-	    geometry.pos().y,
-	    geometry.size().x,
-	    geometry.size().y
-	);
-}
-
-std::string directionToString(const Direction dir) {
-	switch (dir) {
-	case Direction::Up: return "Up";
-	case Direction::Down: return "Down";
-	case Direction::Left: return "Left";
-	case Direction::Right: return "Right";
-	default: return "Unknown";
-	}
-}
-
-std::string toLower(const std::string& str) {
-	std::string result;
-	std::transform(str.begin(), str.end(), std::back_inserter(result), [](unsigned char c) {
-		return std::tolower(c);
-	});
-	return result;
-}
-
-std::optional<Direction> directionFromString(const std::string& str) {
-	const auto lowerStr = toLower(str);
-
-	if (lowerStr == "l" || lowerStr == "left") return Direction::Left;
-	else if (lowerStr == "r" || lowerStr == "right") return Direction::Right;
-	else if (lowerStr == "u" || lowerStr == "up") return Direction::Up;
-	else if (lowerStr == "d" || lowerStr == "down") return Direction::Down;
-	else return {};
-}
-
 SemmetyWorkspaceWrapper* workspace_for_action(bool allow_fullscreen) {
 	auto layout = g_SemmetyLayout;
 	if (layout == nullptr) { return nullptr; }
@@ -121,30 +139,247 @@ std::string escapeSingleQuotes(const std::string& input) {
 	return ss.str();
 }
 
-void updateBar() {
+static wl_event_source* barIdleSource = nullptr;
+static SemmetyBarUpdateStats barUpdateStats;
+
+struct STitleThrottle {
+	std::chrono::steady_clock::time_point lastSent;
+	bool pending = false;
+};
+
+// The window list of each monitor as last gathered. The focused workspace's list is gathered with
+// every publish anyway, the others only when the monitor switched workspace or the wrapper's
+// barRevision moved.
+struct SMonitorWindows {
+	PHLWORKSPACEREF workspace;
+	const SemmetyWorkspaceWrapper* wrapper = nullptr;
+	uint64_t revision = 0;
+	std::vector<SemmetyBarWindowPtr> windows;
+};
+
+static std::unordered_map<std::string, SMonitorWindows> monitorWindows;
+// focus moving between workspaces changes the focused flag on both
+static PHLWINDOWREF monitorWindowsFocus;
+
+static std::unordered_map<PHLWINDOWREF, STitleThrottle> titleThrottles;
+static wl_event_source* titleTimerSource = nullptr;
+static std::optional<std::chrono::steady_clock::time_point> titleTimerDeadline;
+
+static void publishBar() {
 	// Avoid creating workspace wrappers (and thus frames) before the event loop is running.
 	if (!g_semmetyReady) { return; }
 
 	auto workspace_wrapper = workspace_for_action();
 	if (workspace_wrapper == nullptr) {
-		semmety_log(Log::ERR, "no workspace");
+		semmety_log(Ipc, Log::WARN, "no workspace");
 		return;
 	}
 
-	const auto windowsJson = workspace_wrapper->getWorkspaceWindowsJson();
-	const auto workspacesJson = g_SemmetyLayout->getWorkspacesJson();
+	// only gather the topics some client is subscribed to
+	const auto topics = g_SemmetyEventManager->wantedTopics();
+	if (topics == 0) { return; }
+
+	const SemmetySpan span("publishBar");
+
+	SemmetyBarState state {.gathered = topics};
+	if (topics & BAR_TOPIC_WINDOWS) { state.windows = workspace_wrapper->getBarWindows(); }
+	if (topics & BAR_TOPIC_WORKSPACES) { state.workspaces = g_SemmetyLayout->getBarWorkspaces(); }
+	if (topics & BAR_TOPIC_FOCUS) { state.focus = workspace_wrapper->getBarFocus(); }
+	if (topics & BAR_TOPIC_FRAMES) { state.frames = workspace_wrapper->getBarFrames(); }
+
+	if (topics & BAR_TOPIC_MONITORS) {
+		const auto workspaces = (topics & BAR_TOPIC_WORKSPACES) ? state.workspaces
+		                                                        : g_SemmetyLayout->getBarWorkspaces();
+
+		const auto focusedWindow = Desktop::focusState()->window();
+		if (monitorWindowsFocus.lock() != focusedWindow) {
+			for (const auto& window: {monitorWindowsFocus.lock(), focusedWindow}) {
+				if (!window) { continue; }
+				if (auto* wrapper = g_SemmetyLayout->findWorkspaceWrapper(window->m_workspace)) {
+					wrapper->barRevision += 1;
+				}
+			}
+
+			monitorWindowsFocus = focusedWindow;
+		}
+
+		std::erase_if(monitorWindows, [](const auto& entry) {
+			return std::ranges::none_of(g_pCompositor->m_monitors, [&](const auto& monitor) {
+				return monitor->m_name == entry.first;
+			});
+		});
+
+		for (const auto& monitor: g_pCompositor->m_monitors) {
+			SemmetyBarMonitor view {.name = monitor->m_name};
+
+			auto workspace = monitor->m_activeSpecialWorkspace ? monitor->m_activeSpecialWorkspace
+			                                                   : monitor->m_activeWorkspace;
+			// only looked up, a bar publish must not create layout state
+			auto* wrapper = g_SemmetyLayout->findWorkspaceWrapper(workspace);
+
+			auto& cached = monitorWindows[monitor->m_name];
+			if (wrapper != nullptr && wrapper == workspace_wrapper && (topics & BAR_TOPIC_WINDOWS)) {
+				cached = {workspace, wrapper, wrapper->barRevision, state.windows};
+			} else if (cached.workspace != workspace || cached.wrapper != wrapper
+			           || (wrapper != nullptr && cached.revision != wrapper->barRevision)) {
+				cached = {
+				    workspace,
+				    wrapper,
+				    wrapper ? wrapper->barRevision : 0,
+				    wrapper ? wrapper->getBarWindows() : std::vector<SemmetyBarWindowPtr> {},
+				};
+			}
+
+			view.windows = cached.windows;
+
+			for (const auto& barWorkspace: workspaces) {
+				if (barWorkspace.monitor == view.name) { view.workspaces.push_back(barWorkspace); }
+			}
+
+			state.monitors.push_back(std::move(view));
+		}
+	} else {
+		// nothing tracks changes for the cache while no client follows a monitor
+		monitorWindows.clear();
+		monitorWindowsFocus.reset();
+	}
+
+	g_SemmetyEventManager->postBarUpdate(std::move(state));
+	barUpdateStats.published += 1;
+
+	// Every pending title change went out with this update, the trailing edge has nothing to add.
+	const auto now = std::chrono::steady_clock::now();
+	for (auto& [window, throttle]: titleThrottles) {
+		if (!throttle.pending) { continue; }
+
+		throttle.pending = false;
+		throttle.lastSent = now;
+	}
+}
+
+static void onBarIdle(void*) {
+	barIdleSource = nullptr;
+	publishBar();
+}
 
-	const json updateJson = {{"windows", windowsJson}, {"workspaces", workspacesJson}};
+void updateBar() {
+	if (!g_semmetyReady) { return; }
+
+	barUpdateStats.requested += 1;
+	if (barIdleSource != nullptr) {
+		barUpdateStats.coalesced += 1;
+		return;
+	}
+
+	barIdleSource = wl_event_loop_add_idle(g_pCompositor->m_wlEventLoop, onBarIdle, nullptr);
+}
+
+void cancelBarUpdate() {
+	if (barIdleSource != nullptr) {
+		wl_event_source_remove(barIdleSource);
+		barIdleSource = nullptr;
+	}
+
+	if (titleTimerSource != nullptr) {
+		wl_event_source_remove(titleTimerSource);
+		titleTimerSource = nullptr;
+		titleTimerDeadline.reset();
+	}
+
+	titleThrottles.clear();
+}
+
+const SemmetyBarUpdateStats& getBarUpdateStats() { return barUpdateStats; }
+
+static std::chrono::milliseconds getTitleInterval() {
+	static auto PINTERVAL = ConfigValue<Hyprlang::INT>("plugin:semmety:bar_title_interval");
+	return std::chrono::milliseconds(std::max<Hyprlang::INT>(*PINTERVAL, 0));
+}
+
+static int onTitleTimer(void*);
+
+// Arms the shared title timer for `deadline`, unless it is already armed for an earlier one.
+static void armTitleTimer(std::chrono::steady_clock::time_point deadline) {
+	if (titleTimerDeadline && *titleTimerDeadline <= deadline) { return; }
+
+	if (titleTimerSource == nullptr) {
+		titleTimerSource =
+		    wl_event_loop_add_timer(g_pCompositor->m_wlEventLoop, onTitleTimer, nullptr);
+	}
+
+	// wl timers take whole milliseconds and treat 0 as disarm
+	const auto delay = std::chrono::ceil<std::chrono::milliseconds>(
+	    deadline - std::chrono::steady_clock::now()
+	);
+	wl_event_source_timer_update(titleTimerSource, std::max<int>(delay.count(), 1));
+	titleTimerDeadline = deadline;
+}
+
+static int onTitleTimer(void*) {
+	titleTimerDeadline.reset();
+
+	const auto interval = getTitleInterval();
+	const auto now = std::chrono::steady_clock::now();
+
+	bool sendUpdate = false;
+	std::optional<std::chrono::steady_clock::time_point> nextDeadline;
+	for (auto it = titleThrottles.begin(); it != titleThrottles.end();) {
+		auto& [window, throttle] = *it;
+
+		// forget windows that are gone or have been quiet for a full interval
+		if (!window || (!throttle.pending && throttle.lastSent + interval <= now)) {
+			it = titleThrottles.erase(it);
+			continue;
+		}
+
+		if (throttle.pending && throttle.lastSent + interval <= now) {
+			throttle.pending = false;
+			throttle.lastSent = now;
+			sendUpdate = true;
+		}
+
+		const auto deadline = throttle.lastSent + interval;
+		if (!nextDeadline || deadline < *nextDeadline) { nextDeadline = deadline; }
+
+		++it;
+	}
+
+	// one update covers every window whose interval ran out
+	if (sendUpdate) { updateBar(); }
+	if (nextDeadline) { armTitleTimer(*nextDeadline); }
+
+	return 0;
+}
+
+void updateBarForTitleChange(PHLWINDOW window) {
+	const auto interval = getTitleInterval();
+	if (interval.count() == 0) {
+		updateBar();
+		return;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	auto& throttle = titleThrottles[window];
+	const auto elapsed = now - throttle.lastSent;
+
+	if (!throttle.pending && elapsed >= interval) {
+		throttle.lastSent = now;
+		updateBar();
+	} else {
+		// too soon after the last update for this window, hold the change back until the interval
+		// is over so the final title of a burst is still sent
+		throttle.pending = true;
+	}
 
-	auto jsonString = updateJson.dump();
-	g_SemmetyEventManager->postBarUpdate(jsonString);
+	// the timer sends the held back change, or forgets the window once it has been quiet
+	armTitleTimer(throttle.lastSent + interval);
 }
 
 void focusWindow(PHLWINDOWREF window) {
 	auto focused_window = Desktop::focusState()->window();
 	if (focused_window == window) { return; }
 	if (window) {
-		semmety_log(Log::ERR, "Focusing window {}", window->fetchTitle());
+		semmety_trace(Layout, "Focusing window {}", window->fetchTitle());
 
 		if (window->isHidden()) { window->setHidden(false); }
 		Desktop::focusState()->fullWindowFocus(window.lock(), Desktop::FOCUS_REASON_OTHER);
@@ -13,14 +13,9 @@
 #include <hyprland/src/render/pass/BorderPassElement.hpp>
 #include <hyprlang.hpp>
 
+#include "SemmetyFrameUtils.hpp"
 #include "globals.hpp"
 
-enum class Direction { Up, Right, Down, Left };
-
-std::string toLower(const std::string& str);
-std::optional<Direction> directionFromString(const std::string& str);
-std::string directionToString(const Direction dir);
-std::string getGeometryString(const CBox geometry);
 std::optional<size_t> getFocusHistoryIndex(PHLWINDOW wnd);
 SemmetyWorkspaceWrapper* workspace_for_action(bool allow_fullscreen = true);
 SemmetyWorkspaceWrapper* workspace_for_window(PHLWINDOW window);
@@ -28,7 +23,20 @@ void focusWindow(PHLWINDOWREF window);
 std::string windowToString(PHLWINDOWREF window);
 std::string getCallStackAsString(int maxFrames);
 
+// Bar updates are coalesced: updateBar() only marks the bar dirty and schedules a single idle
+// callback on the event loop, which serializes and publishes the state once.
+struct SemmetyBarUpdateStats {
+	uint64_t requested = 0;
+	uint64_t coalesced = 0;
+	uint64_t published = 0;
+};
+
 void updateBar();
+// Title changes are rate limited per window to one bar update every
+// plugin:semmety:bar_title_interval ms. The last change in a burst is always sent.
+void updateBarForTitleChange(PHLWINDOW window);
+void cancelBarUpdate();
+const SemmetyBarUpdateStats& getBarUpdateStats();
 void shouldUpdateBar();
 
 template <>
@@ -0,0 +1,17 @@
+#pragma once
+
+// Stand-in for the parts of Hyprland's CCompositor the event manager uses, so it can run outside
+// the compositor. The benchmark owns the event loop and plays the compositor thread.
+
+#include <string>
+
+#include "defines.hpp"
+
+class CCompositor {
+public:
+	std::string m_instancePath;
+	wl_event_loop* m_wlEventLoop = nullptr;
+	bool m_isShuttingDown = false;
+};
+
+inline UP<CCompositor> g_pCompositor;
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdio>
+#include <format>
+#include <string>
+
+// Only errors are printed, so a benchmark run isn't slowed down by the event manager's logging.
+namespace Log {
+	enum eLogLevel {
+		TRACE,
+		DEBUG,
+		INFO,
+		WARN,
+		ERR,
+		CRIT,
+	};
+
+	class CLogger {
+	public:
+		template <typename... Args>
+		void log(eLogLevel level, std::format_string<Args...> fmt, Args&&... args) {
+			if (level < ERR) { return; }
+
+			const auto message = std::format(fmt, std::forward<Args>(args)...);
+			std::fprintf(stderr, "%s\n", message.c_str());
+		}
+	};
+
+	inline CLogger* logger = new CLogger;
+} // namespace Log
+
+namespace Hyprutils::CLI {
+	using eLogLevel = Log::eLogLevel;
+} // namespace Hyprutils::CLI
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <wayland-server-core.h>
+
+#include "helpers/memory/Memory.hpp"